@@ -21,6 +21,12 @@ namespace {
 // Index in the instance object's internal fields for the DefaultPrevented flag.
 int kInternalEventDefaultPreventedIndex = 0;
 
+// Index in the instance object's internal fields for the plugin::Arguments of lazy events.
+int kInternalEventArgumentsIndex = 1;
+
+// Number of internal fields that instance objects of events will have.
+int kInternalEventFieldCount = 2;
+
 // Map from SA-MP callback name to idiomatic JavaScript event type.
 std::unordered_map<std::string, std::string> g_callback_type_map_;
 
@@ -98,28 +104,57 @@ const std::string& Event::ToEventType(const std::string& callback) {
 
 Event::Event(const plugin::Callback& callback) 
     : callback_(callback),
-      event_type_(CreateEventInterfaceName(callback.name)) {}
+      type_(ToEventType(callback.name)),
+      event_type_(CreateEventInterfaceName(callback.name)) {
+  // Events carrying strings or arrays will materialize their properties lazily, as converting
+  // those is relatively expensive, and listeners generally are interested in a subset of them.
+  for (const auto& argument : callback_.arguments) {
+    if (argument.second == plugin::ARGUMENT_TYPE_STRING ||
+        argument.second == plugin::ARGUMENT_TYPE_ARRAY) {
+      lazy_ = true;
+    }
+  }
+}
 
-Event::~Event() {}
+Event::~Event() = default;
 
-void Event::InstallPrototype(v8::Local<v8::ObjectTemplate> global) const {
+void Event::InstallPrototype(v8::Local<v8::ObjectTemplate> global) {
   v8::Isolate* isolate = v8::Isolate::GetCurrent();
 
   v8::Local<v8::FunctionTemplate> function_template = v8::FunctionTemplate::New(isolate);
   v8::Local<v8::ObjectTemplate> object_template = function_template->InstanceTemplate();
 
+  // Make sure that there is a location to store the DefaultPrevented flag and the arguments.
+  object_template->SetInternalFieldCount(kInternalEventFieldCount);
+
+  argument_names_.clear();
+  argument_names_.reserve(callback_.arguments.size());
+
+  accessors_.clear();
+  accessors_.reserve(callback_.arguments.size());
+
   // TODO: Special-case "playerid", "vehicleid" and so on.
-  for (const auto& pair : callback_.arguments)
-    object_template->Set(v8String(pair.first), v8::Undefined(isolate));
+  for (const auto& pair : callback_.arguments) {
+    v8::Local<v8::String> name =
+        v8::String::NewFromUtf8(isolate, pair.first.c_str(), v8::NewStringType::kInternalized,
+                                static_cast<int>(pair.first.size())).ToLocalChecked();
+
+    argument_names_.emplace_back(isolate, name);
+
+    if (lazy_) {
+      accessors_.push_back({ this, accessors_.size() });
+      object_template->SetLazyDataProperty(
+          name, LazyArgumentGetter, v8::External::New(isolate, &accessors_.back()));
+    } else {
+      object_template->Set(name, v8::Undefined(isolate));
+    }
+  }
 
   // If the event is cancelable, we create the property "defaultPrevented" (a readonly boolean)
   // and the method preventDefault() to set it to true. This effect is irreversible.
   if (callback_.cancelable) {
     v8::Local<v8::ObjectTemplate> prototype_template = function_template->PrototypeTemplate();
 
-    // Make sure that there is a location to store the DefaultPrevented flag.
-    object_template->SetInternalFieldCount(1 /** kInternalEventDefaultPreventedIndex **/);
-
     prototype_template->Set(v8String("preventDefault"),
                             v8::FunctionTemplate::New(isolate, PreventDefaultCallback));
 
@@ -131,56 +166,115 @@ void Event::InstallPrototype(v8::Local<v8::ObjectTemplate> global) const {
   }
 
   global->Set(v8String(event_type_), function_template);
+
+  function_template_.Set(isolate, function_template);
+  constructor_.Reset();
 }
 
-v8::Local<v8::Object> Event::NewInstance(const plugin::Arguments& arguments) const {
+v8::Local<v8::Object> Event::NewInstance(const plugin::Arguments& arguments) {
   v8::Isolate* isolate = v8::Isolate::GetCurrent();
   v8::Local<v8::Context> context = isolate->GetCurrentContext();
 
-  v8::Local<v8::Value> function_value = context->Global()->Get(context, v8String(event_type_)).ToLocalChecked();
-  DCHECK(function_value->IsFunction());
+  if (constructor_.IsEmpty()) {
+    DCHECK(!function_template_.IsEmpty());
+
+    v8::Local<v8::FunctionTemplate> function_template = function_template_.Get(isolate);
+    constructor_.Reset(isolate, function_template->GetFunction(context).ToLocalChecked());
+  }
 
-  v8::Local<v8::Function> function = v8::Local<v8::Function>::Cast(function_value);
+  v8::Local<v8::Function> function = constructor_.Get(isolate);
   v8::Local<v8::Object> instance = function->NewInstance(context).ToLocalChecked();
 
-  for (const auto& argument : callback_.arguments) {
-    v8::Local<v8::String> property = v8String(argument.first);
+  // Lazy events will read their properties from the |arguments| when they're first accessed.
+  if (lazy_) {
+    instance->SetInternalField(kInternalEventArgumentsIndex,
+                               v8::External::New(isolate, const_cast<plugin::Arguments*>(&arguments)));
+    return instance;
+  }
 
-    // Special case "content" from the CAC_OnMemoryRead callback, which should be an Uint8Array
-    // instead of a string. std::string is still used to carry the data.
-    if (event_type_ == "CAC_OnMemoryReadEvent" && argument.first == "content") {
-      const std::vector<uint32_t>& data = arguments.GetArray(argument.first);
+  for (size_t index = 0; index < callback_.arguments.size(); ++index) {
+    instance->Set(context, argument_names_[index].Get(isolate),
+                  ConvertArgument(isolate, arguments, index));
+  }
 
-      v8::Local<v8::Array> array = v8::Array::New(isolate, data.size());
-      for (size_t index = 0; index < data.size(); ++index)
-        array->Set(context, index, v8::Number::New(isolate, data[index]));
-      
-      instance->Set(context, property, array);
-      continue;
-    }
+  return instance;
+}
 
-    switch (argument.second) {
-    case plugin::ARGUMENT_TYPE_INT:
-      instance->Set(context, property, v8::Number::New(isolate, arguments.GetInteger(argument.first)));
-      break;
+void Event::Detach(v8::Local<v8::Object> instance) {
+  if (!lazy_)
+    return;  // the instance does not depend on the arguments
 
-    case plugin::ARGUMENT_TYPE_FLOAT:
-      instance->Set(context, property, v8::Number::New(isolate, arguments.GetFloat(argument.first)));
-      break;
+  v8::Isolate* isolate = v8::Isolate::GetCurrent();
+  v8::Local<v8::Context> context = isolate->GetCurrentContext();
 
-    case plugin::ARGUMENT_TYPE_STRING:
-      {
-        const std::string& string = arguments.GetString(argument.first);
-        auto maybe = v8::String::NewFromOneByte(
-            isolate, (const uint8_t*) &string[0], v8::NewStringType::kNormal, string.size());
+  v8::Local<v8::Value> field = instance->GetInternalField(kInternalEventArgumentsIndex);
+  if (field.IsEmpty() || !field->IsExternal())
+    return;
+
+  // Reading the properties invokes the lazy getters of those that haven't been accessed yet, which
+  // V8 will replace with data properties. Properties that have been read are already data.
+  for (const auto& name : argument_names_)
+    instance->Get(context, name.Get(isolate));
+
+  instance->SetInternalField(kInternalEventArgumentsIndex, v8::Undefined(isolate));
+}
+
+// static
+void Event::LazyArgumentGetter(v8::Local<v8::Name> property,
+                               const v8::PropertyCallbackInfo<v8::Value>& info) {
+  const ArgumentAccessor* accessor =
+      static_cast<ArgumentAccessor*>(v8::Local<v8::External>::Cast(info.Data())->Value());
 
-        instance->Set(context, property, maybe.ToLocalChecked());
-      }
-      break;
+  v8::Local<v8::Object> holder = info.Holder();
+  if (holder->InternalFieldCount() <= kInternalEventArgumentsIndex)
+    return;
+
+  v8::Local<v8::Value> field = holder->GetInternalField(kInternalEventArgumentsIndex);
+  if (field.IsEmpty() || !field->IsExternal())
+    return;
+
+  const plugin::Arguments* arguments =
+      static_cast<plugin::Arguments*>(v8::Local<v8::External>::Cast(field)->Value());
+
+  info.GetReturnValue().Set(
+      accessor->event->ConvertArgument(info.GetIsolate(), *arguments, accessor->index));
+}
+
+v8::Local<v8::Value> Event::ConvertArgument(v8::Isolate* isolate,
+                                            const plugin::Arguments& arguments,
+                                            size_t index) const {
+  const auto& argument = callback_.arguments[index];
+
+  switch (argument.second) {
+  case plugin::ARGUMENT_TYPE_INT:
+    return v8::Number::New(isolate, arguments.GetInteger(index));
+
+  case plugin::ARGUMENT_TYPE_FLOAT:
+    return v8::Number::New(isolate, arguments.GetFloat(index));
+
+  case plugin::ARGUMENT_TYPE_STRING:
+    {
+      const std::string& string = arguments.GetString(index);
+      auto maybe = v8::String::NewFromOneByte(
+          isolate, (const uint8_t*) &string[0], v8::NewStringType::kNormal, string.size());
+
+      return maybe.ToLocalChecked();
+    }
+
+  case plugin::ARGUMENT_TYPE_ARRAY:
+    {
+      v8::Local<v8::Context> context = isolate->GetCurrentContext();
+      const std::vector<uint32_t>& data = arguments.GetArray(index);
+
+      v8::Local<v8::Array> array = v8::Array::New(isolate, data.size());
+      for (size_t element = 0; element < data.size(); ++element)
+        array->Set(context, element, v8::Number::New(isolate, data[element]));
+
+      return array;
     }
   }
 
-  return instance;
+  return v8::Undefined(isolate);
 }
 
 }  // namespace bindings
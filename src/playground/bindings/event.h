@@ -7,6 +7,9 @@
 
 #include <memory>
 #include <string>
+#include <vector>
+
+#include <include/v8.h>
 
 #include "base/macros.h"
 #include "plugin/callback.h"
@@ -15,13 +18,6 @@ namespace plugin {
 class Arguments;
 }
 
-namespace v8 {
-template <class T> class Local;
-class Object;
-class ObjectTemplate;
-class Value;
-}
-
 namespace bindings {
 
 // The Event class represents a dynamically created event based on SA-MP callbacks. The events
@@ -42,22 +38,77 @@ class Event {
 
   ~Event();
 
-  // Installs the prototype for this event on the |global| template.
-  void InstallPrototype(v8::Local<v8::ObjectTemplate> global) const;
+  // Installs the prototype for this event on the |global| template. The property names used by
+  // the event's instances will be created and internalized here as well.
+  void InstallPrototype(v8::Local<v8::ObjectTemplate> global);
 
   // Creates a new instance of the event filled with the data from |arguments|. The returned object
   // may immediately be used to dispatch the event on the script's global scope.
-  v8::Local<v8::Object> NewInstance(const plugin::Arguments& arguments) const;
+  //
+  // Events carrying strings are lazy: their properties will be read from |arguments| when they are
+  // first accessed during dispatch. Detach() must be called before |arguments| is destroyed.
+  v8::Local<v8::Object> NewInstance(const plugin::Arguments& arguments);
+
+  // Returns the callback represented by this event.
+  const plugin::Callback& callback() const { return callback_; }
+
+  // Returns the idiomatic JavaScript event type of this event, e.g. "playerconnect".
+  const std::string& type() const { return type_; }
+
+  // Gets or sets the Id of the event type through which this event will be dispatched.
+  size_t type_id() const { return type_id_; }
+  void set_type_id(size_t type_id) { type_id_ = type_id; }
+
+  // Detaches the |instance| from the arguments it was created with. Properties that have not been
+  // read during dispatch are materialized, after which the |instance| no longer refers to native
+  // storage. To be called when the dispatch of the event has finished.
+  void Detach(v8::Local<v8::Object> instance);
 
  private:
   explicit Event(const plugin::Callback& callback);
 
+  // Data associated with the lazy accessor of each of the event's properties.
+  struct ArgumentAccessor {
+    Event* event;
+    size_t index;
+  };
+
+  // Getter for lazy event properties. Reads the value from the event's arguments.
+  static void LazyArgumentGetter(v8::Local<v8::Name> property,
+                                 const v8::PropertyCallbackInfo<v8::Value>& info);
+
+  // Converts the argument at |index| in |arguments| to a JavaScript value.
+  v8::Local<v8::Value> ConvertArgument(v8::Isolate* isolate,
+                                       const plugin::Arguments& arguments,
+                                       size_t index) const;
+
   // Signature of the callback represented by this event.
   plugin::Callback callback_;
 
+  // The idiomatic JavaScript event type of the callback.
+  std::string type_;
+
   // The event type associated with the callback.
   std::string event_type_;
 
+  // Id of the event type, as assigned by the GlobalScope.
+  size_t type_id_ = 0;
+
+  // Whether the properties of this event's instances should be materialized lazily.
+  bool lazy_ = false;
+
+  // Accessor data for each of the callback's arguments, only used for lazy events.
+  std::vector<ArgumentAccessor> accessors_;
+
+  // The function template from which instances of this event will be created.
+  v8::Eternal<v8::FunctionTemplate> function_template_;
+
+  // The constructor of this event. Lazily created, as this requires the context to exist.
+  v8::Global<v8::Function> constructor_;
+
+  // Internalized names of each of the callback's arguments, in order of the arguments.
+  std::vector<v8::Eternal<v8::String>> argument_names_;
+
   DISALLOW_COPY_AND_ASSIGN(Event);
 };
 
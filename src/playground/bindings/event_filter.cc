@@ -0,0 +1,41 @@
+// Copyright 2020 Las Venturas Playground. All rights reserved.
+// Use of this source code is governed by the MIT license, a copy of which can
+// be found in the LICENSE file.
+
+#include "bindings/event_filter.h"
+
+#include <algorithm>
+
+#include "plugin/arguments.h"
+
+namespace bindings {
+
+EventFilter::EventFilter() = default;
+
+EventFilter::~EventFilter() = default;
+
+void EventFilter::AddPredicate(const std::string& field, int argument_index,
+                               std::vector<int32_t> values) {
+  std::sort(values.begin(), values.end());
+
+  predicates_.push_back(Predicate { field, argument_index, std::move(values) });
+}
+
+// static
+bool EventFilter::Accepts(const Predicate& predicate, int32_t value) {
+  return std::binary_search(predicate.values.begin(), predicate.values.end(), value);
+}
+
+bool EventFilter::Matches(const plugin::Arguments& arguments) const {
+  for (const Predicate& predicate : predicates_) {
+    if (predicate.argument_index < 0)
+      return false;  // the field is not provided by the |arguments|.
+
+    if (!Accepts(predicate, arguments.GetInteger(predicate.argument_index)))
+      return false;
+  }
+
+  return true;
+}
+
+}  // namespace bindings
@@ -0,0 +1,57 @@
+// Copyright 2020 Las Venturas Playground. All rights reserved.
+// Use of this source code is governed by the MIT license, a copy of which can
+// be found in the LICENSE file.
+
+#ifndef PLAYGROUND_BINDINGS_EVENT_FILTER_H_
+#define PLAYGROUND_BINDINGS_EVENT_FILTER_H_
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace plugin {
+class Arguments;
+}
+
+namespace bindings {
+
+// Filter that can be attached to an event listener, so that the listener will only be invoked for
+// the events it's interested in. This enables events to be filtered without waking up JavaScript.
+//
+// A filter consists of predicates on integral fields of the event, all of which must match. Each
+// predicate matches when the value of the field is one of the predicate's values.
+class EventFilter {
+ public:
+  struct Predicate {
+    // Name of the field, and the index of the callback argument that provides it. The index will
+    // be -1 for events that are not backed by a callback, e.g. those dispatched by JavaScript.
+    std::string field;
+    int argument_index;
+
+    // Sorted list of the values accepted by this predicate.
+    std::vector<int32_t> values;
+  };
+
+  EventFilter();
+  ~EventFilter();
+
+  // Adds a predicate requiring |field|, provided by the argument at |argument_index|, to be equal
+  // to one of the |values|.
+  void AddPredicate(const std::string& field, int argument_index, std::vector<int32_t> values);
+
+  // Returns whether the predicate accepts the given |value|.
+  static bool Accepts(const Predicate& predicate, int32_t value);
+
+  // Returns whether the |arguments| of an intercepted callback match this filter.
+  bool Matches(const plugin::Arguments& arguments) const;
+
+  const std::vector<Predicate>& predicates() const { return predicates_; }
+  bool empty() const { return predicates_.empty(); }
+
+ private:
+  std::vector<Predicate> predicates_;
+};
+
+}  // namespace bindings
+
+#endif  // PLAYGROUND_BINDINGS_EVENT_FILTER_H_
@@ -0,0 +1,45 @@
+// Copyright 2020 Las Venturas Playground. All rights reserved.
+// Use of this source code is governed by the MIT license, a copy of which can
+// be found in the LICENSE file.
+
+#include "bindings/event_filter.h"
+
+#include "gtest/gtest.h"
+#include "plugin/arguments.h"
+
+namespace bindings {
+
+TEST(EventFilterTest, MatchesArguments) {
+  plugin::Arguments arguments;
+  arguments.Reset(2);
+  arguments.SetInteger(0, 12);
+  arguments.SetInteger(1, 1234);
+
+  EventFilter filter;
+  EXPECT_TRUE(filter.empty());
+  EXPECT_TRUE(filter.Matches(arguments));
+
+  filter.AddPredicate("dialogid", 1, { 1234 });
+  EXPECT_TRUE(filter.Matches(arguments));
+
+  filter.AddPredicate("playerid", 0, { 50, 12, 3 });
+  EXPECT_TRUE(filter.Matches(arguments));
+
+  arguments.SetInteger(0, 13);
+  EXPECT_FALSE(filter.Matches(arguments));
+}
+
+TEST(EventFilterTest, UnresolvedFields) {
+  plugin::Arguments arguments;
+  arguments.Reset(1);
+  arguments.SetInteger(0, 1);
+
+  EventFilter filter;
+  filter.AddPredicate("playerid", -1, { 1 });
+
+  EXPECT_FALSE(filter.Matches(arguments));
+  EXPECT_TRUE(EventFilter::Accepts(filter.predicates()[0], 1));
+  EXPECT_FALSE(EventFilter::Accepts(filter.predicates()[0], 2));
+}
+
+}  // namespace bindings
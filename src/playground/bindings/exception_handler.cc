@@ -22,7 +22,7 @@ const char kAnonymousFunction[] = "`anonymous function`";
 
 // Stack of exception sources. Entries can only be added or removed by using ScopedExceptionSource
 // instances when invoking functionality on the v8 runtime.
-std::stack<std::string> g_exception_sources_;
+std::stack<const char*> g_exception_sources_;
 
 // Stack of sources that thrown exceptions should be attributed to.
 std::stack<std::pair<base::FilePath, int>> g_attribution_stack_;
@@ -53,7 +53,7 @@ void RegisterError(v8::Local<v8::Value> error) {
       ->RegisterAttributedError(error, pair.first, pair.second);
 }
 
-ScopedExceptionSource::ScopedExceptionSource(const std::string& source) {
+ScopedExceptionSource::ScopedExceptionSource(const char* source) {
   g_exception_sources_.push(source);
 }
 
@@ -157,7 +157,7 @@ void ExceptionHandler::OnMessage(v8::Local<v8::Message> message, v8::Local<v8::V
   }
 
   if (g_exception_sources_.size())
-    runtime_delegate_->OnScriptOutput("    from " + g_exception_sources_.top());
+    runtime_delegate_->OnScriptOutput(std::string("    from ") + g_exception_sources_.top());
 
   runtime_delegate_->OnScriptOutput("=========================");
 }
@@ -25,10 +25,11 @@ struct ScopedExceptionAttribution {
 void RegisterError(v8::Local<v8::Value> error);
 
 // A scoped exception source may be used to improve the clarity of exceptions generated by code ran
-// because we invoked JavaScript for some reason. The reason will be included in the output.
+// because we invoked JavaScript for some reason. The reason will be included in the output. The
+// |source| is not copied, and must outlive the scope.
 class ScopedExceptionSource {
  public:
-  explicit ScopedExceptionSource(const std::string& source);
+  explicit ScopedExceptionSource(const char* source);
   ~ScopedExceptionSource();
 };
 
@@ -34,9 +34,13 @@
 
 namespace bindings {
 
-// void addEventListener(string type, function listener);
+// void addEventListener(string type, function listener[, object options]);
+//
+// The |options| may contain a |filter| object, mapping integral fields of the event to either a
+// number or an array of numbers. The listener will only be invoked for events matching the filter.
 void AddEventListenerCallback(const v8::FunctionCallbackInfo<v8::Value>& arguments) {
   GlobalScope* global = Runtime::FromIsolate(arguments.GetIsolate())->GetGlobalScope();
+  auto context = arguments.GetIsolate()->GetCurrentContext();
 
   if (arguments.Length() < 2) {
     ThrowException("unable to execute addEventListener(): 2 arguments required, but only " +
@@ -54,7 +58,55 @@ void AddEventListenerCallback(const v8::FunctionCallbackInfo<v8::Value>& argumen
     return;
   }
 
-  global->AddEventListener(toString(arguments[0]), v8::Local<v8::Function>::Cast(arguments[1]));
+  EventFilter filter;
+
+  if (arguments.Length() >= 3 && arguments[2]->IsObject()) {
+    v8::Local<v8::Object> options = v8::Local<v8::Object>::Cast(arguments[2]);
+    v8::Local<v8::Value> filter_value;
+
+    if (options->Get(context, v8String("filter")).ToLocal(&filter_value) &&
+        !filter_value->IsUndefined()) {
+      if (!filter_value->IsObject()) {
+        ThrowException("unable to execute addEventListener(): expected an object for the filter.");
+        return;
+      }
+
+      v8::Local<v8::Object> filter_object = v8::Local<v8::Object>::Cast(filter_value);
+      v8::Local<v8::Array> fields;
+      if (!filter_object->GetOwnPropertyNames(context).ToLocal(&fields))
+        return;
+
+      for (uint32_t index = 0; index < fields->Length(); ++index) {
+        v8::Local<v8::Value> field = fields->Get(context, index).ToLocalChecked();
+        v8::Local<v8::Value> value = filter_object->Get(context, field).ToLocalChecked();
+
+        std::vector<v8::Local<v8::Value>> candidates;
+        if (value->IsArray()) {
+          v8::Local<v8::Array> array = v8::Local<v8::Array>::Cast(value);
+          for (uint32_t element = 0; element < array->Length(); ++element)
+            candidates.push_back(array->Get(context, element).ToLocalChecked());
+        } else {
+          candidates.push_back(value);
+        }
+
+        std::vector<int32_t> values;
+        for (const auto& candidate : candidates) {
+          if (!candidate->IsInt32()) {
+            ThrowException("unable to execute addEventListener(): expected integers for filter " +
+                           toString(field) + ".");
+            return;
+          }
+
+          values.push_back(candidate->Int32Value(context).ToChecked());
+        }
+
+        filter.AddPredicate(toString(field), -1 /* argument_index */, std::move(values));
+      }
+    }
+  }
+
+  global->AddEventListener(toString(arguments[0]), v8::Local<v8::Function>::Cast(arguments[1]),
+                           std::move(filter));
 }
 
 static std::string Base64Transform(const std::string& input, bool encode) {
@@ -142,6 +194,24 @@ void Base64EncodeCallback(const v8::FunctionCallbackInfo<v8::Value>& arguments)
     arguments.GetReturnValue().Set(v8_encoded.ToLocalChecked());
 }
 
+// Int32Array callPublicBatch(string name, string format, array packedArgs);
+//
+// Calls the Pawn public function |name| once for each set of |format| arguments in |packedArgs|,
+// and returns the values it returned. See PawnInvoke::CallPublicBatch() for more information.
+void CallPublicBatchCallback(const v8::FunctionCallbackInfo<v8::Value>& arguments) {
+  GlobalScope* global = Runtime::FromIsolate(arguments.GetIsolate())->GetGlobalScope();
+
+  if (arguments.Length() < 3) {
+    ThrowException("unable to execute callPublicBatch(): 3 arguments required, but only " +
+                   std::to_string(arguments.Length()) + " provided.");
+    return;
+  }
+
+  v8::Local<v8::Value> results = global->GetPawnInvoke()->CallPublicBatch(arguments);
+  if (!results.IsEmpty())
+    arguments.GetReturnValue().Set(results);
+}
+
 // void clearModuleCache(string prefix);
 void ClearModuleCacheCallback(const v8::FunctionCallbackInfo<v8::Value>& arguments) {
   auto runtime = Runtime::FromIsolate(arguments.GetIsolate());
@@ -255,34 +325,135 @@ void FlushExceptionQueueCallback(const v8::FunctionCallbackInfo<v8::Value>& argu
     exception_handler->FlushMessageQueue();
 }
 
-// sequence<object { type, event }> getDeferredEvents();
+// sequence<object { type, count, sequence, columns }> getDeferredEvents();
+//
+// Returns the queued deferred events grouped by their callback. The |sequence| typed array holds
+// the global order in which the events were received, whereas |columns| maps each of the callback's
+// argument names to a typed array (Int32Array or Float32Array) or an array of strings.
 void GetDeferredEventsCallback(const v8::FunctionCallbackInfo<v8::Value>& arguments) {
   v8::Isolate* isolate = arguments.GetIsolate();
   auto context = isolate->GetCurrentContext();
 
   GlobalScope* global = Runtime::FromIsolate(isolate)->GetGlobalScope();
-  GlobalScope::DeferredEventMultimapType& deferred_events = global->deferred_events();
+  plugin::DeferredEventQueue& deferred_events = global->deferred_events();
 
-  v8::Local<v8::Array> events = v8::Array::New(isolate, deferred_events.size());
-  v8::Local<v8::Name> names[] = { v8String("type"), v8String("event") };
+  v8::Local<v8::Array> batches = v8::Array::New(isolate);
+  v8::Local<v8::Name> names[] = {
+    v8String("type"), v8String("count"), v8String("sequence"), v8String("columns") };
 
-  uint32_t index = 0;
-  for (auto& [type, arguments] : deferred_events) {
-    Event* event = global->GetEvent(type);
-    if (!event) {
-      LOG(ERROR) << "Unrecognized event name: " << type << ". Dropping deferred event.";
+  uint32_t batch_index = 0;
+  for (const auto& ring : deferred_events.rings()) {
+    if (!ring || !ring->size())
       continue;
+
+    const plugin::Callback& callback = ring->callback();
+    const size_t count = ring->size();
+
+    v8::Local<v8::ArrayBuffer> sequence_buffer =
+        v8::ArrayBuffer::New(isolate, count * sizeof(uint32_t));
+    ring->CopySequences(static_cast<uint32_t*>(sequence_buffer->GetBackingStore()->Data()));
+
+    v8::Local<v8::Object> columns = v8::Object::New(isolate);
+    for (size_t column = 0; column < callback.arguments.size(); ++column) {
+      const auto& argument = callback.arguments[column];
+      v8::Local<v8::Value> values;
+
+      switch (argument.second) {
+      case plugin::ARGUMENT_TYPE_INT:
+      case plugin::ARGUMENT_TYPE_FLOAT:
+        {
+          v8::Local<v8::ArrayBuffer> buffer = v8::ArrayBuffer::New(isolate, count * sizeof(int32_t));
+          ring->CopyCells(column, static_cast<int32_t*>(buffer->GetBackingStore()->Data()));
+
+          if (argument.second == plugin::ARGUMENT_TYPE_FLOAT)
+            values = v8::Float32Array::New(buffer, 0, count);
+          else
+            values = v8::Int32Array::New(buffer, 0, count);
+        }
+        break;
+      case plugin::ARGUMENT_TYPE_STRING:
+        {
+          v8::Local<v8::Array> strings = v8::Array::New(isolate, count);
+          for (size_t index = 0; index < count; ++index) {
+            const std::string& string = ring->GetString(column, index);
+            strings->Set(context, index, v8::String::NewFromOneByte(
+                isolate, (const uint8_t*) string.c_str(), v8::NewStringType::kNormal,
+                string.size()).ToLocalChecked());
+          }
+
+          values = strings;
+        }
+        break;
+      case plugin::ARGUMENT_TYPE_ARRAY:
+        values = v8::Undefined(isolate);  // not supported for deferred callbacks
+        break;
+      }
+
+      columns->Set(context, v8String(argument.first), values);
     }
 
-    v8::Local<v8::Value> event_values[] = { v8String(type), event->NewInstance(arguments) };
+    v8::Local<v8::Value> batch_values[] = {
+      v8String(callback.name),
+      v8::Number::New(isolate, count),
+      v8::Uint32Array::New(sequence_buffer, 0, count),
+      columns
+    };
 
-    events->Set(
-        context, index++, v8::Object::New(isolate, v8::Null(isolate), names, event_values, 2));
+    batches->Set(context, batch_index++,
+                 v8::Object::New(isolate, v8::Null(isolate), names, batch_values, 4));
   }
 
-  deferred_events.clear();
+  deferred_events.Clear();
 
-  arguments.GetReturnValue().Set(events);
+  arguments.GetReturnValue().Set(batches);
+}
+
+// object getPlayerStateMirror([number refreshInterval = 100]);
+//
+// Returns an object with a typed array for each of the mirrored player state fields, indexed by
+// player Id. The arrays are views on memory owned by the plugin, which will be updated when players
+// send updates to the server, at most once per |refreshInterval| milliseconds. A |refreshInterval|
+// of zero disables mirroring. Multiple calls will return the same object.
+void GetPlayerStateMirrorCallback(const v8::FunctionCallbackInfo<v8::Value>& arguments) {
+  v8::Isolate* isolate = arguments.GetIsolate();
+  auto context = isolate->GetCurrentContext();
+
+  GlobalScope* global = Runtime::FromIsolate(isolate)->GetGlobalScope();
+
+  double refresh_interval = 100;  // milliseconds
+  if (arguments.Length() >= 1) {
+    if (!arguments[0]->IsNumber() || arguments[0]->NumberValue(context).ToChecked() < 0) {
+      ThrowException("unable to execute getPlayerStateMirror(): expected a non-negative number "
+                     "for argument 1.");
+      return;
+    }
+
+    refresh_interval = arguments[0]->NumberValue(context).ToChecked();
+  }
+
+  arguments.GetReturnValue().Set(global->GetPlayerStateMirror(isolate, refresh_interval));
+}
+
+// Int32Array? getSharedBuffer(string name);
+//
+// Returns an Int32Array over the global array that Pawn shared as |name| using the
+// RegisterSharedBuffer() native, or null when no such buffer exists. Reads and writes operate on
+// the AMX's memory directly. The array will be detached when the buffer is no longer valid.
+void GetSharedBufferCallback(const v8::FunctionCallbackInfo<v8::Value>& arguments) {
+  GlobalScope* global = Runtime::FromIsolate(arguments.GetIsolate())->GetGlobalScope();
+
+  if (arguments.Length() < 1) {
+    ThrowException("unable to execute getSharedBuffer(): 1 argument required, but none provided.");
+    return;
+  }
+
+  if (!arguments[0]->IsString()) {
+    ThrowException("unable to execute getSharedBuffer(): expected a string for argument 1.");
+    return;
+  }
+
+  arguments.GetReturnValue().Set(
+      global->GetSharedBuffer(arguments.GetIsolate(), toString(arguments[0])));
 }
 
 #define ADD_NUMBER(name, value) \
@@ -299,10 +470,26 @@ void GetRuntimeStatisticsCallback(const v8::FunctionCallbackInfo<v8::Value>& arg
   v8::Local<v8::Object> object = v8::Object::New(isolate);
 
   ADD_NUMBER("deferred_event_queue_size", global->deferred_events().size());
+  ADD_NUMBER("deferred_event_dropped", global->deferred_events().dropped());
+  ADD_NUMBER("deferred_event_merged", global->deferred_events().merged());
   ADD_NUMBER("event_handler_size", global->event_handler_count());
+  ADD_NUMBER("provided_native_async_queue_size", global->GetProvidedNatives()->async_call_count());
   ADD_NUMBER("exception_handler_queue_size", runtime->GetExceptionHandler()->size());
+  ADD_NUMBER("module_code_cache_hit", runtime->GetModulator()->code_cache_hits());
+  ADD_NUMBER("module_code_cache_rejected", runtime->GetModulator()->code_cache_rejects());
   ADD_NUMBER("timer_queue_size", runtime->GetTimerQueue()->size());
 
+  // Number of dropped deferred events per callback, for those that had to drop any.
+  v8::Local<v8::Object> dropped = v8::Object::New(isolate);
+  for (const auto& ring : global->deferred_events().rings()) {
+    if (ring && ring->dropped()) {
+      dropped->Set(context, v8String(ring->callback().name),
+                   v8::Number::New(isolate, ring->dropped()));
+    }
+  }
+
+  object->Set(context, v8String("deferred_event_dropped_by_type"), dropped);
+
   arguments.GetReturnValue().Set(object);
 }
 
@@ -461,7 +648,40 @@ void PawnInvokeCallback(const v8::FunctionCallbackInfo<v8::Value>& arguments) {
   arguments.GetReturnValue().Set(global->GetPawnInvoke()->Call(arguments));
 }
 
-// void provideNative(string name, string parameters, function handler);
+// void pawnInvokeDeferred(string name, string signature[, ...]);
+void PawnInvokeDeferredCallback(const v8::FunctionCallbackInfo<v8::Value>& arguments) {
+  GlobalScope* global = Runtime::FromIsolate(arguments.GetIsolate())->GetGlobalScope();
+
+  if (arguments.Length() < 2) {
+    ThrowException("unable to execute pawnInvokeDeferred(): 2 arguments required, but only " +
+                   std::to_string(arguments.Length()) + " provided.");
+    return;
+  }
+
+  global->GetPawnInvoke()->CallDeferred(arguments);
+}
+
+// int pawnNativeId(string name);
+void PawnNativeIdCallback(const v8::FunctionCallbackInfo<v8::Value>& arguments) {
+  GlobalScope* global = Runtime::FromIsolate(arguments.GetIsolate())->GetGlobalScope();
+
+  if (arguments.Length() == 0) {
+    ThrowException("unable to execute pawnNativeId(): 1 argument required, but 0 provided.");
+    return;
+  }
+
+  if (!arguments[0]->IsString()) {
+    ThrowException("unable to execute pawnNativeId(): expected a string for argument 1.");
+    return;
+  }
+
+  arguments.GetReturnValue().Set(global->GetPawnInvoke()->GetNativeId(toString(arguments[0])));
+}
+
+// void provideNative(string name, string parameters, function handler[, object options]);
+//
+// The |options| may set |async| to true for natives without reference parameters, in which case
+// calls will be queued and the |handler| will be invoked at the next server frame.
 void ProvideNativeCallback(const v8::FunctionCallbackInfo<v8::Value>& arguments) {
   GlobalScope* global = Runtime::FromIsolate(arguments.GetIsolate())->GetGlobalScope();
 
@@ -470,7 +690,7 @@ void ProvideNativeCallback(const v8::FunctionCallbackInfo<v8::Value>& arguments)
     return;
   }
 
-  if (arguments.Length() != 3) {
+  if (arguments.Length() < 3) {
     ThrowException("unable to execute provideNative(): 3 argument required, but only " +
                    std::to_string(arguments.Length()) + " provided.");
     return;
@@ -491,10 +711,25 @@ void ProvideNativeCallback(const v8::FunctionCallbackInfo<v8::Value>& arguments)
     return;
   }
 
+  bool async = false;
+  if (arguments.Length() >= 4 && !arguments[3]->IsUndefined()) {
+    if (!arguments[3]->IsObject()) {
+      ThrowException("unable to execute provideNative(): expected an object for argument 4.");
+      return;
+    }
+
+    auto context = arguments.GetIsolate()->GetCurrentContext();
+    v8::Local<v8::Object> options = v8::Local<v8::Object>::Cast(arguments[3]);
+
+    v8::Local<v8::Value> async_value;
+    if (options->Get(context, v8String("async")).ToLocal(&async_value))
+      async = async_value->BooleanValue(arguments.GetIsolate());
+  }
+
   const std::string name = toString(arguments[0]);
   const std::string parameters = toString(arguments[1]);
 
-  if (!global->GetProvidedNatives()->Register(name, parameters, v8::Local<v8::Function>::Cast(arguments[2])))
+  if (!global->GetProvidedNatives()->Register(name, parameters, v8::Local<v8::Function>::Cast(arguments[2]), async))
     ThrowException("unable to execute provideNative(): the native could not be registered.");
 }
 
@@ -15,12 +15,15 @@ namespace bindings {
 void AddEventListenerCallback(const v8::FunctionCallbackInfo<v8::Value>& arguments);
 void Base64DecodeCallback(const v8::FunctionCallbackInfo<v8::Value>& arguments);
 void Base64EncodeCallback(const v8::FunctionCallbackInfo<v8::Value>& arguments);
+void CallPublicBatchCallback(const v8::FunctionCallbackInfo<v8::Value>& arguments);
 void ClearModuleCacheCallback(const v8::FunctionCallbackInfo<v8::Value>& arguments);
 void DispatchEventCallback(const v8::FunctionCallbackInfo<v8::Value>& arguments);
 void ExecCallback(const v8::FunctionCallbackInfo<v8::Value>& arguments);
 void FrameCounterCallback(const v8::FunctionCallbackInfo<v8::Value>& arguments);
 void FlushExceptionQueueCallback(const v8::FunctionCallbackInfo<v8::Value>& arguments);
 void GetDeferredEventsCallback(const v8::FunctionCallbackInfo<v8::Value>& arguments);
+void GetPlayerStateMirrorCallback(const v8::FunctionCallbackInfo<v8::Value>& arguments);
+void GetSharedBufferCallback(const v8::FunctionCallbackInfo<v8::Value>& arguments);
 void GetRuntimeStatisticsCallback(const v8::FunctionCallbackInfo<v8::Value>& arguments);
 void GlobCallback(const v8::FunctionCallbackInfo<v8::Value>& arguments);
 void HasEventListenersCallback(const v8::FunctionCallbackInfo<v8::Value>& arguments);
@@ -30,6 +33,8 @@ void IsPlayerMinimizedCallback(const v8::FunctionCallbackInfo<v8::Value>& argume
 void NotifyReadyCallback(const v8::FunctionCallbackInfo<v8::Value>& arguments);
 void KillServerCallback(const v8::FunctionCallbackInfo<v8::Value>& arguments);
 void PawnInvokeCallback(const v8::FunctionCallbackInfo<v8::Value>& arguments);
+void PawnInvokeDeferredCallback(const v8::FunctionCallbackInfo<v8::Value>& arguments);
+void PawnNativeIdCallback(const v8::FunctionCallbackInfo<v8::Value>& arguments);
 void ProvideNativeCallback(const v8::FunctionCallbackInfo<v8::Value>& arguments);
 void ReadFileCallback(const v8::FunctionCallbackInfo<v8::Value>& arguments);
 void RemoveEventListenerCallback(const v8::FunctionCallbackInfo<v8::Value>& arguments);
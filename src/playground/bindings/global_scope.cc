@@ -23,6 +23,7 @@
 #include "bindings/timer_queue.h"
 #include "bindings/utilities.h"
 #include "performance/scoped_trace.h"
+#include "plugin/player_state_mirror.h"
 #include "plugin/plugin_controller.h"
 
 namespace bindings {
@@ -41,9 +42,30 @@ GlobalScope::GlobalScope(plugin::PluginController* plugin_controller)
 GlobalScope::~GlobalScope() = default;
 
 void GlobalScope::RegisterEvent(const std::string& type, std::unique_ptr<Event> event) {
+  const size_t callback_id = event->callback().id;
+  if (callback_id >= callback_events_.size())
+    callback_events_.resize(callback_id + 1, nullptr);
+
+  event->set_type_id(GetEventTypeId(event->type()));
+
+  callback_events_[callback_id] = event.get();
   events_[type].swap(event);
 }
 
+size_t GlobalScope::GetEventTypeId(const std::string& type) {
+  auto type_id_iter = event_type_ids_.find(type);
+  if (type_id_iter != event_type_ids_.end())
+    return type_id_iter->second;
+
+  const size_t type_id = event_types_.size();
+
+  event_types_.emplace_back(new EventType {
+      type, "dispatched event `" + type + "`", EventListenerVector() });
+  event_type_ids_.emplace(type, type_id);
+
+  return type_id;
+}
+
 void GlobalScope::InstallPrototypes(v8::Local<v8::ObjectTemplate> global) {
   // Install the event listener functions (as defined by HTML's EventTarget interface, although
   // we add support for hasEventListeners since it matters for internal performance).
@@ -53,13 +75,18 @@ void GlobalScope::InstallPrototypes(v8::Local<v8::ObjectTemplate> global) {
   InstallFunction(global, "removeEventListener", RemoveEventListenerCallback);
 
   // Install the other functions that should be available on |global|.
+  InstallFunction(global, "callPublicBatch", CallPublicBatchCallback);
   InstallFunction(global, "clearModuleCache", ClearModuleCacheCallback);
   InstallFunction(global, "frameCounter", FrameCounterCallback);
   InstallFunction(global, "flushExceptionQueue", FlushExceptionQueueCallback);
   InstallFunction(global, "getDeferredEvents", GetDeferredEventsCallback);
+  InstallFunction(global, "getPlayerStateMirror", GetPlayerStateMirrorCallback);
   InstallFunction(global, "getRuntimeStatistics", GetRuntimeStatisticsCallback);
+  InstallFunction(global, "getSharedBuffer", GetSharedBufferCallback);
   InstallFunction(global, "highResolutionTime", HighResolutionTimeCallback);
   InstallFunction(global, "pawnInvoke", PawnInvokeCallback);
+  InstallFunction(global, "pawnInvokeDeferred", PawnInvokeDeferredCallback);
+  InstallFunction(global, "pawnNativeId", PawnNativeIdCallback);
   InstallFunction(global, "provideNative", ProvideNativeCallback);
   InstallFunction(global, "startTrace", StartTraceCallback);
   InstallFunction(global, "stopTrace", StopTraceCallback);
@@ -131,77 +158,162 @@ Event* GlobalScope::GetEvent(const std::string& type) {
   return event_iter->second.get();
 }
 
-void GlobalScope::StoreDeferredEvent(const std::string& type, plugin::Arguments arguments) {
-  deferred_events_.insert({ type, std::move(arguments) });
+Event* GlobalScope::GetEvent(const plugin::Callback& callback) {
+  if (callback.id >= callback_events_.size())
+    return nullptr;
+
+  return callback_events_[callback.id];
+}
+
+void GlobalScope::StoreDeferredEvent(const plugin::Callback& callback,
+                                     const plugin::Arguments& arguments) {
+  deferred_events_.Push(callback, arguments);
 }
 
 void GlobalScope::VerifyNoEventHandlersLeft() {
   size_t warnings = 0;
 
-  for (const auto& iter : event_listeners_) {
-    const size_t count = iter.second.size();
+  for (const auto& event_type : event_types_) {
+    const size_t count = event_type->listeners.size();
     if (!count)
       continue;
 
-    LOG(WARNING) << "The event " << iter.first << " still has " << count << " attached listeners.";
+    LOG(WARNING) << "The event " << event_type->type << " still has " << count
+                 << " attached listeners.";
     ++warnings;
   }
 
   if (warnings > 0)
     LOG(WARNING) << "Not clearing the event listener map.";
-  else
-    event_listeners_.clear();
 }
 
-void GlobalScope::AddEventListener(const std::string& type, v8::Local<v8::Function> listener) {
-  event_listeners_[type].push_back(
-      v8::Persistent<v8::Function>(v8::Isolate::GetCurrent(), listener));
+bool GlobalScope::AddEventListener(const std::string& type, v8::Local<v8::Function> listener,
+                                   EventFilter filter) {
+  EventFilter resolved_filter;
+
+  if (!filter.empty()) {
+    // Find the callback that provides events of |type|, if any, to resolve the filtered fields.
+    const plugin::Callback* callback = nullptr;
+    for (const auto& [name, event] : events_) {
+      if (Event::ToEventType(name) == type)
+        callback = &event->callback();
+    }
+
+    for (const auto& predicate : filter.predicates()) {
+      int argument_index = -1;
+
+      if (callback) {
+        for (size_t index = 0; index < callback->arguments.size(); ++index) {
+          if (callback->arguments[index].first == predicate.field)
+            argument_index = static_cast<int>(index);
+        }
+
+        if (argument_index == -1 ||
+            callback->arguments[argument_index].second != plugin::ARGUMENT_TYPE_INT) {
+          ThrowException("unable to execute addEventListener(): events of type " + type +
+                         " do not have an integral field named " + predicate.field + ".");
+          return false;
+        }
+      }
+
+      resolved_filter.AddPredicate(predicate.field, argument_index, predicate.values);
+    }
+  }
+
+  event_types_[GetEventTypeId(type)]->listeners.push_back(EventListener {
+      v8PersistentFunctionReference(v8::Isolate::GetCurrent(), listener),
+      std::move(resolved_filter) });
+
+  return true;
 }
 
-bool GlobalScope::DispatchEvent(const std::string& type, v8::Local<v8::Value> event) const {
-  auto event_list_iter = event_listeners_.find(type);
-  if (event_list_iter == event_listeners_.end())
+bool GlobalScope::DispatchEvent(const std::string& type, v8::Local<v8::Value> event,
+                                const plugin::Arguments* arguments) const {
+  auto type_id_iter = event_type_ids_.find(type);
+  if (type_id_iter == event_type_ids_.end())
     return false;  // this can happen for developer-defined callbacks.
 
+  return DispatchEvent(type_id_iter->second, event, arguments);
+}
+
+bool GlobalScope::DispatchEvent(size_t type_id, v8::Local<v8::Value> event,
+                                const plugin::Arguments* arguments) const {
+  DCHECK(type_id < event_types_.size());
+
+  const EventType& event_type = *event_types_[type_id];
+  if (event_type.listeners.empty())
+    return false;
+
   v8::Isolate* isolate = v8::Isolate::GetCurrent();
 
-  // Initialize an array with the |event| value that will be available.
-  v8::Local<v8::Value> arguments[1];
-  arguments[0] = event;
+  // Number of listeners that can be dispatched to without allocating memory.
+  constexpr size_t kInlineListenerCount = 16;
 
-  ScopedExceptionSource source("dispatched event `" + type + "`");
+  // Snapshot the listeners interested in this event before invoking any of them, as they may add
+  // or remove listeners, which would invalidate iterators in to |event_type.listeners|.
+  v8::Local<v8::Function> inline_functions[kInlineListenerCount];
+  std::vector<v8::Local<v8::Function>> overflow_functions;
+
+  v8::Local<v8::Function>* functions = inline_functions;
+  if (event_type.listeners.size() > kInlineListenerCount) {
+    overflow_functions.resize(event_type.listeners.size());
+    functions = overflow_functions.data();
+  }
+
+  size_t function_count = 0;
+
+  for (const auto& [persistent_function, filter] : event_type.listeners) {
+    if (!filter.empty()) {
+      if (arguments ? !filter.Matches(*arguments) : !FilterAcceptsObject(filter, event))
+        continue;  // the listener is not interested in this event.
+    }
 
-  for (const auto& persistent_function : event_list_iter->second) {
     if (persistent_function.IsEmpty()) {
-      LOG(WARNING) << "[v8] Empty function found for event " << type;
+      LOG(WARNING) << "[v8] Empty function found for event " << event_type.type;
       continue;
     }
 
-    // Convert the persistent function to a local one again, without losing the persistent reference
-    // (which may be done if the listener removes itself from the event target).
-    v8::Local<v8::Function> function = v8::Local<v8::Function>::New(isolate, persistent_function);
+    functions[function_count++] = v8::Local<v8::Function>::New(isolate, persistent_function);
+  }
 
-    if (function.IsEmpty()) {
-      LOG(WARNING) << "[v8] Unable to coerce the persistent funtion to a local for event " << type;
-      continue;
+  // Initialize an array with the |event| value that will be available.
+  v8::Local<v8::Value> function_arguments[1];
+  function_arguments[0] = event;
 
-    } else {
-      //performance::ScopedTrace trace(performance::INTERCEPTED_CALLBACK_EVENT_HANDLER,
-      //                               type, function->GetScriptOrigin(), function->GetScriptLineNumber());
+  ScopedExceptionSource source(event_type.exception_source.c_str());
 
-      Call(isolate, function, arguments, 1u);
-    }
-  }
+  for (size_t index = 0; index < function_count; ++index)
+    Call(isolate, functions[index], function_arguments, 1u);
 
   return Event::DefaultPrevented(event);
 }
 
 bool GlobalScope::HasEventListeners(const std::string& type) const {
-  auto event_list_iter = event_listeners_.find(type);
-  if (event_list_iter == event_listeners_.end())
+  const EventType* event_type = FindEventType(type);
+  if (!event_type)
+    return false;
+
+  return event_type->listeners.size() > 0;
+}
+
+bool GlobalScope::HasEventListeners(const std::string& type,
+                                    const plugin::Arguments& arguments) const {
+  auto type_id_iter = event_type_ids_.find(type);
+  if (type_id_iter == event_type_ids_.end())
     return false;
 
-  return event_list_iter->second.size() > 0;
+  return HasEventListeners(type_id_iter->second, arguments);
+}
+
+bool GlobalScope::HasEventListeners(size_t type_id, const plugin::Arguments& arguments) const {
+  DCHECK(type_id < event_types_.size());
+
+  for (const auto& listener : event_types_[type_id]->listeners) {
+    if (listener.filter.empty() || listener.filter.Matches(arguments))
+      return true;
+  }
+
+  return false;
 }
 
 double GlobalScope::HighResolutionTime() const {
@@ -212,23 +324,110 @@ bool GlobalScope::IsPlayerMinimized(int player_id, double current_time) const {
   return plugin_controller_->IsPlayerMinimized(player_id, current_time);
 }
 
+v8::Local<v8::Value> GlobalScope::GetSharedBuffer(v8::Isolate* isolate, const std::string& name) {
+  auto view_iter = shared_buffers_.find(name);
+  if (view_iter != shared_buffers_.end())
+    return view_iter->second.Get(isolate);
+
+  const plugin::SharedBufferRegistry::SharedBuffer* shared_buffer =
+      plugin_controller_->shared_buffers().Find(name);
+  if (!shared_buffer)
+    return v8::Null(isolate);
+
+  // The memory is owned by the AMX, so it must not be released by v8. Views will be detached
+  // through DetachSharedBuffer() before the memory becomes invalid.
+  std::shared_ptr<v8::BackingStore> backing_store = v8::ArrayBuffer::NewBackingStore(
+      shared_buffer->data, shared_buffer->size * sizeof(int32_t), [](void*, size_t, void*) {},
+      nullptr);
+
+  v8::Local<v8::ArrayBuffer> buffer = v8::ArrayBuffer::New(isolate, std::move(backing_store));
+  v8::Local<v8::Int32Array> view = v8::Int32Array::New(buffer, 0, shared_buffer->size);
+
+  shared_buffers_[name].Reset(isolate, view);
+  return view;
+}
+
+void GlobalScope::DetachSharedBuffer(const std::string& name) {
+  auto view_iter = shared_buffers_.find(name);
+  if (view_iter == shared_buffers_.end())
+    return;
+
+  v8::Local<v8::Int32Array> view = view_iter->second.Get(v8::Isolate::GetCurrent());
+  view->Buffer()->Detach();
+
+  shared_buffers_.erase(view_iter);
+}
+
+v8::Local<v8::Object> GlobalScope::GetPlayerStateMirror(v8::Isolate* isolate,
+                                                       double refresh_interval) {
+  plugin::PlayerStateMirror* mirror = plugin_controller_->player_state_mirror();
+  mirror->set_refresh_interval(refresh_interval);
+
+  if (!player_state_mirror_.IsEmpty())
+    return player_state_mirror_.Get(isolate);
+
+  auto context = isolate->GetCurrentContext();
+
+  const size_t count = plugin::PlayerStateMirror::kMaxPlayers;
+  v8::Local<v8::Object> object = v8::Object::New(isolate);
+
+  // The views are backed by the mirror's own storage, which outlives the runtime. Ownership of
+  // the memory thus must not be transferred to v8, hence the empty deleter.
+  auto create_buffer = [&](void* data, size_t byte_length) {
+    return v8::ArrayBuffer::New(isolate, v8::ArrayBuffer::NewBackingStore(
+        data, byte_length, [](void*, size_t, void*) {}, nullptr));
+  };
+
+  const std::pair<const char*, plugin::PlayerStateMirror::FloatField> float_fields[] = {
+    { "positionX", plugin::PlayerStateMirror::FLOAT_FIELD_POSITION_X },
+    { "positionY", plugin::PlayerStateMirror::FLOAT_FIELD_POSITION_Y },
+    { "positionZ", plugin::PlayerStateMirror::FLOAT_FIELD_POSITION_Z },
+    { "health", plugin::PlayerStateMirror::FLOAT_FIELD_HEALTH },
+    { "armour", plugin::PlayerStateMirror::FLOAT_FIELD_ARMOUR },
+  };
+
+  for (const auto& [name, field] : float_fields) {
+    v8::Local<v8::ArrayBuffer> buffer =
+        create_buffer(mirror->float_field(field), count * sizeof(float));
+    object->Set(context, v8String(name), v8::Float32Array::New(buffer, 0, count));
+  }
+
+  const std::pair<const char*, plugin::PlayerStateMirror::IntegerField> integer_fields[] = {
+    { "state", plugin::PlayerStateMirror::INTEGER_FIELD_STATE },
+    { "vehicleId", plugin::PlayerStateMirror::INTEGER_FIELD_VEHICLE_ID },
+    { "interior", plugin::PlayerStateMirror::INTEGER_FIELD_INTERIOR },
+    { "virtualWorld", plugin::PlayerStateMirror::INTEGER_FIELD_VIRTUAL_WORLD },
+  };
+
+  for (const auto& [name, field] : integer_fields) {
+    v8::Local<v8::ArrayBuffer> buffer =
+        create_buffer(mirror->integer_field(field), count * sizeof(int32_t));
+    object->Set(context, v8String(name), v8::Int32Array::New(buffer, 0, count));
+  }
+
+  player_state_mirror_.Reset(isolate, object);
+  return object;
+}
+
 void GlobalScope::RemoveEventListener(const std::string& type, v8::Local<v8::Function> listener) {
-  auto event_list_iter = event_listeners_.find(type);
-  if (event_list_iter == event_listeners_.end())
+  auto type_id_iter = event_type_ids_.find(type);
+  if (type_id_iter == event_type_ids_.end())
     return;
 
+  EventListenerVector& listeners = event_types_[type_id_iter->second]->listeners;
+
   // Remove all associated event listeners if the |listener| was not passed.
   if (listener.IsEmpty()) {
-    event_listeners_.erase(event_list_iter);
+    listeners.clear();
     return;
   }
 
   // Attempt to find the |listener| in the list of listeners associated with event |type|. If it's
   // found, remove it, and continue - it's possible to register listeners multiple times.
-  auto event_listener_iter = event_list_iter->second.begin();
-  while (event_listener_iter != event_list_iter->second.end()) {
-    if (listener == *event_listener_iter)
-      event_listener_iter = event_list_iter->second.erase(event_listener_iter);
+  auto event_listener_iter = listeners.begin();
+  while (event_listener_iter != listeners.end()) {
+    if (listener == event_listener_iter->function)
+      event_listener_iter = listeners.erase(event_listener_iter);
     else
       event_listener_iter++;
   }
@@ -260,12 +459,40 @@ v8::Local<v8::Promise> GlobalScope::Wait(Runtime* runtime, int64_t time) {
 size_t GlobalScope::event_handler_count() const {
   size_t count = 0;
 
-  for (const auto& [name, listeners] : event_listeners_)
-    count += listeners.size();
+  for (const auto& event_type : event_types_)
+    count += event_type->listeners.size();
 
   return count;
 }
 
+const GlobalScope::EventType* GlobalScope::FindEventType(const std::string& type) const {
+  auto type_id_iter = event_type_ids_.find(type);
+  if (type_id_iter == event_type_ids_.end())
+    return nullptr;
+
+  return event_types_[type_id_iter->second].get();
+}
+
+// static
+bool GlobalScope::FilterAcceptsObject(const EventFilter& filter, v8::Local<v8::Value> event) {
+  if (event.IsEmpty() || !event->IsObject())
+    return false;
+
+  v8::Local<v8::Context> context = GetContext();
+  v8::Local<v8::Object> object = v8::Local<v8::Object>::Cast(event);
+
+  for (const auto& predicate : filter.predicates()) {
+    v8::Local<v8::Value> value;
+    if (!object->Get(context, v8String(predicate.field)).ToLocal(&value) || !value->IsInt32())
+      return false;
+
+    if (!EventFilter::Accepts(predicate, value->Int32Value(context).ToChecked()))
+      return false;
+  }
+
+  return true;
+}
+
 void GlobalScope::InstallFunction(v8::Local<v8::ObjectTemplate> global,
                                   const std::string& name, v8::FunctionCallback callback) {
   global->Set(v8String(name),
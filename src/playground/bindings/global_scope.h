@@ -14,11 +14,14 @@
 #include <include/v8.h>
 
 #include "base/macros.h"
+#include "bindings/event_filter.h"
 #include "bindings/provided_natives.h"
-#include "plugin/arguments.h"
+#include "plugin/deferred_event_queue.h"
 
 namespace plugin {
+class Arguments;
 class PluginController;
+struct Callback;
 }
 
 namespace bindings {
@@ -44,15 +47,18 @@ class StreamerModule;
 // it gets deleted before the v8 context or isolate. Failing to do so will result in a SEGFAULT.
 class GlobalScope {
  public:
-  using DeferredEventMultimapType = std::unordered_multimap<std::string, plugin::Arguments>;
-
   explicit GlobalScope(plugin::PluginController* plugin_controller);
   ~GlobalScope();
 
   // Registers |event| as the interface for handling events of type |type|. All event types must
-  // be registered before the InstallPrototypes() method gets called.
+  // be registered before the InstallPrototypes() method gets called. The event will be assigned
+  // the Id of the event type through which it is dispatched.
   void RegisterEvent(const std::string& type, std::unique_ptr<Event> event);
 
+  // Returns the Id of the event type |type|, creating it when it doesn't exist yet. Ids are stable
+  // for the lifetime of the global scope, and can be used to avoid string lookups.
+  size_t GetEventTypeId(const std::string& type);
+
   // Installs the prototypes for global objects on the |global| template. This is the first of a
   // two-pass global object initialization sequence.
   void InstallPrototypes(v8::Local<v8::ObjectTemplate> global);
@@ -67,8 +73,11 @@ class GlobalScope {
   // Accessor providing access to the instances of created event types.
   Event* GetEvent(const std::string& type);
 
-  // Stores the deferred event of the given |type| with the given |arguments| for later use.
-  void StoreDeferredEvent(const std::string& type, plugin::Arguments arguments);
+  // Returns the event registered for |callback|, or a nullptr. This is an O(1) operation.
+  Event* GetEvent(const plugin::Callback& callback);
+
+  // Stores the deferred event for |callback| with the given |arguments| for later use.
+  void StoreDeferredEvent(const plugin::Callback& callback, const plugin::Arguments& arguments);
 
   // Verifies that there are no more event handlers left registered, once testing has finished.
   void VerifyNoEventHandlersLeft();
@@ -80,17 +89,34 @@ class GlobalScope {
 
  public:
   // Implementation of the addEventListener() function, which registers |listener| as a handler
-  // for events of type |type|. A persistent reference to |listener| will be created.
-  void AddEventListener(const std::string& type, v8::Local<v8::Function> listener);
+  // for events of type |type|. A persistent reference to |listener| will be created. The fields
+  // of the |filter| will be resolved to the event's arguments. Returns false, with an exception
+  // having been thrown, when the |filter| refers to fields that cannot be filtered on.
+  bool AddEventListener(const std::string& type, v8::Local<v8::Function> listener,
+                        EventFilter filter = EventFilter());
 
   // Implementation of the dispatchEvent() function, which will invoke all listeners registered for
-  // events of type |type|. The |event| value will be re-used for each invocation.
-  bool DispatchEvent(const std::string& type, v8::Local<v8::Value> event) const;
+  // events of type |type|. The |event| value will be re-used for each invocation. Listeners that
+  // have a filter will be checked against the |arguments| when given, or against the properties
+  // of the |event| otherwise.
+  bool DispatchEvent(const std::string& type, v8::Local<v8::Value> event,
+                     const plugin::Arguments* arguments = nullptr) const;
+
+  // Dispatches the |event| to the listeners of the event type identified by |type_id|. Listeners
+  // are determined before the first is invoked, so adding or removing listeners for this event
+  // type will only take effect for subsequent dispatches.
+  bool DispatchEvent(size_t type_id, v8::Local<v8::Value> event,
+                     const plugin::Arguments* arguments = nullptr) const;
 
   // Implementation of the hasEventListeners() function, which returns whether there are any
   // registered event listeners for events of type |type|.
   bool HasEventListeners(const std::string& type) const;
 
+  // Returns whether there are any event listeners for events of type |type| that are interested
+  // in an event with the given |arguments|, i.e. whose filter will not reject it.
+  bool HasEventListeners(const std::string& type, const plugin::Arguments& arguments) const;
+  bool HasEventListeners(size_t type_id, const plugin::Arguments& arguments) const;
+
   // Implementation of the highResolutionTime() global function, which will return a timing value
   // with sub-millisecond precision.
   double HighResolutionTime() const;
@@ -98,6 +124,18 @@ class GlobalScope {
   // Implementation of the isPlayerMinimized() global function.
   bool IsPlayerMinimized(int player_id, double current_time) const;
 
+  // Implementation of the getSharedBuffer() global function. Returns an Int32Array over the memory
+  // of the buffer that Pawn shared as |name|, or null when no such buffer exists.
+  v8::Local<v8::Value> GetSharedBuffer(v8::Isolate* isolate, const std::string& name);
+
+  // Detaches the views on the buffer that was shared as |name|, as its memory is no longer valid.
+  void DetachSharedBuffer(const std::string& name);
+
+  // Implementation of the getPlayerStateMirror() global function. Returns an object with typed
+  // array views on each of the mirrored player state fields, created when first requested. The
+  // mirror will be refreshed at most once per |refresh_interval|, in milliseconds.
+  v8::Local<v8::Object> GetPlayerStateMirror(v8::Isolate* isolate, double refresh_interval);
+
   // Implementation of the removeEventListener() function, which will remove |listener| from the
   // persistently held list of handlers for events of type |type|. If |listener| is an empty
   // reference, all associated listeners for events of type |type| will be removed.
@@ -109,7 +147,7 @@ class GlobalScope {
   // Returns a promise that will be resolved after |time| milliseconds.
   v8::Local<v8::Promise> Wait(Runtime* runtime, int64_t time);
 
-  DeferredEventMultimapType& deferred_events() { return deferred_events_; }
+  plugin::DeferredEventQueue& deferred_events() { return deferred_events_; }
   size_t event_handler_count() const;
 
  private:
@@ -145,14 +183,47 @@ class GlobalScope {
   // Map of callback names to the Event* instance that defines their interface.
   std::unordered_map<std::string, std::unique_ptr<Event>> events_;
 
-  // Map of deferred events that haven't yet been pulled by JavaScript.
-  DeferredEventMultimapType deferred_events_;
+  // Vector of the events indexed by the Id of the callback they represent. Weak references.
+  std::vector<Event*> callback_events_;
+
+  // Queue of deferred events that haven't yet been pulled by JavaScript.
+  plugin::DeferredEventQueue deferred_events_;
 
   using v8PersistentFunctionReference = v8::Persistent<v8::Function, v8::CopyablePersistentTraits<v8::Function>>;
-  using v8PersistentFunctionVector = std::vector<v8PersistentFunctionReference>;
 
-  // Map of event type to list of event listeners, stored as persistent references to v8 functions.
-  std::unordered_map<std::string, v8PersistentFunctionVector> event_listeners_;
+  struct EventListener {
+    v8PersistentFunctionReference function;
+    EventFilter filter;
+  };
+
+  using EventListenerVector = std::vector<EventListener>;
+
+  // Information associated with an event type. The |exception_source| is created once, to avoid
+  // string operations when events of this type are being dispatched.
+  struct EventType {
+    std::string type;
+    std::string exception_source;
+    EventListenerVector listeners;
+  };
+
+  // Returns the event type identified by |type|, or a nullptr when it's not known.
+  const EventType* FindEventType(const std::string& type) const;
+
+  // Returns whether the |filter| accepts the |event|, when it has been dispatched by JavaScript.
+  static bool FilterAcceptsObject(const EventFilter& filter, v8::Local<v8::Value> event);
+
+  // Event types indexed by their Id, together with the list of event listeners for each of them
+  // stored as persistent references to v8 functions. Entries are never removed.
+  std::vector<std::unique_ptr<EventType>> event_types_;
+
+  // Map of event type to the Id assigned to it.
+  std::unordered_map<std::string, size_t> event_type_ids_;
+
+  // Views on the buffers shared by Pawn that have been requested by JavaScript, keyed by name.
+  std::unordered_map<std::string, v8::Global<v8::Int32Array>> shared_buffers_;
+
+  // Object holding the typed array views on the player state mirror, once it has been requested.
+  v8::Global<v8::Object> player_state_mirror_;
 
   bool has_shown_warning_ = false;
 
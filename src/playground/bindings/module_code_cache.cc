@@ -0,0 +1,168 @@
+// Copyright 2020 Las Venturas Playground. All rights reserved.
+// Use of this source code is governed by the MIT license, a copy of which can
+// be found in the LICENSE file.
+
+#include "bindings/module_code_cache.h"
+
+#include <stdio.h>
+#include <boost/filesystem.hpp>
+#include <fstream>
+
+#include "base/logging.h"
+
+namespace fs = boost::filesystem;
+
+namespace bindings {
+namespace {
+
+// Magic number identifying the entry files, and the version of their format.
+const uint32_t kEntryMagic = 0x43534A50;  // "PJSC"
+const uint32_t kEntryFormatVersion = 1;
+
+// Upper bound on the size of an entry's code, to guard against reading corrupted files.
+const uint32_t kMaxCodeSize = 64 * 1024 * 1024;
+
+// Computes the 64-bit FNV-1a hash of the |length| bytes in |data|.
+uint64_t ComputeHash(const char* data, size_t length) {
+  uint64_t hash = 0xCBF29CE484222325ull;
+  for (size_t index = 0; index < length; ++index) {
+    hash ^= static_cast<uint8_t>(data[index]);
+    hash *= 0x100000001B3ull;
+  }
+
+  return hash;
+}
+
+template <typename T>
+void WriteValue(std::ofstream& stream, const T& value) {
+  stream.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+void WriteString(std::ofstream& stream, const std::string& value) {
+  WriteValue(stream, static_cast<uint32_t>(value.size()));
+  stream.write(value.data(), value.size());
+}
+
+template <typename T>
+bool ReadValue(std::ifstream& stream, T* value) {
+  return !!stream.read(reinterpret_cast<char*>(value), sizeof(T));
+}
+
+// Reads a string from the |stream|, and returns whether it equals the |expected| string.
+bool ReadAndCompareString(std::ifstream& stream, const std::string& expected) {
+  uint32_t length = 0;
+  if (!ReadValue(stream, &length) || length != expected.size())
+    return false;
+
+  std::string value(length, '\0');
+  if (length && !stream.read(&value[0], length))
+    return false;
+
+  return value == expected;
+}
+
+}  // namespace
+
+ModuleCodeCache::ModuleCodeCache(const base::FilePath& directory, const std::string& version)
+    : directory_(directory),
+      version_(version) {}
+
+ModuleCodeCache::~ModuleCodeCache() = default;
+
+// static
+uint64_t ModuleCodeCache::ComputeSourceHash(const std::string& source) {
+  return ComputeHash(source.data(), source.size());
+}
+
+bool ModuleCodeCache::Load(const base::FilePath& path, uint64_t source_hash,
+                           std::vector<uint8_t>* data) const {
+  std::ifstream stream(GetEntryPath(path).value().c_str(), std::ios::in | std::ios::binary);
+  if (!stream.is_open())
+    return false;  // there is no entry for the |path|
+
+  uint32_t magic = 0, format_version = 0;
+  if (!ReadValue(stream, &magic) || magic != kEntryMagic)
+    return false;
+
+  if (!ReadValue(stream, &format_version) || format_version != kEntryFormatVersion)
+    return false;
+
+  // The entry must have been created by the same version of v8, for the same module (rather than
+  // one whose path happens to have the same hash), with the same source code.
+  if (!ReadAndCompareString(stream, version_) || !ReadAndCompareString(stream, path.value()))
+    return false;
+
+  uint64_t entry_source_hash = 0;
+  if (!ReadValue(stream, &entry_source_hash) || entry_source_hash != source_hash)
+    return false;
+
+  uint32_t length = 0;
+  if (!ReadValue(stream, &length) || !length || length > kMaxCodeSize)
+    return false;
+
+  data->resize(length);
+  if (!stream.read(reinterpret_cast<char*>(data->data()), length)) {
+    data->clear();
+    return false;
+  }
+
+  return true;
+}
+
+bool ModuleCodeCache::Store(const base::FilePath& path, uint64_t source_hash, const uint8_t* data,
+                            size_t length) {
+  if (!length || length > kMaxCodeSize)
+    return false;
+
+  boost::system::error_code error;
+  fs::create_directories(fs::path(directory_.value()), error);
+  if (error) {
+    LOG(WARNING) << "Unable to create the code cache directory: " << error.message();
+    return false;
+  }
+
+  // Write the entry to a temporary file first, to avoid leaving a partial entry behind.
+  const std::string entry_path = GetEntryPath(path).value();
+  const std::string temporary_path = entry_path + ".tmp";
+  {
+    std::ofstream stream(temporary_path.c_str(),
+                         std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!stream.is_open())
+      return false;
+
+    WriteValue(stream, kEntryMagic);
+    WriteValue(stream, kEntryFormatVersion);
+    WriteString(stream, version_);
+    WriteString(stream, path.value());
+    WriteValue(stream, source_hash);
+    WriteValue(stream, static_cast<uint32_t>(length));
+
+    stream.write(reinterpret_cast<const char*>(data), length);
+    if (!stream.flush())
+      return false;
+  }
+
+  fs::rename(fs::path(temporary_path), fs::path(entry_path), error);
+  if (error) {
+    fs::remove(fs::path(temporary_path), error);
+    return false;
+  }
+
+  return true;
+}
+
+void ModuleCodeCache::Remove(const base::FilePath& path) {
+  boost::system::error_code error;
+  fs::remove(fs::path(GetEntryPath(path).value()), error);
+}
+
+base::FilePath ModuleCodeCache::GetEntryPath(const base::FilePath& path) const {
+  const uint64_t hash = ComputeHash(path.value().data(), path.value().size());
+
+  char filename[32];
+  snprintf(filename, sizeof(filename), "%016llx.bin", static_cast<unsigned long long>(hash));
+
+  return directory_.Append(filename);
+}
+
+}  // namespace bindings
@@ -0,0 +1,53 @@
+// Copyright 2020 Las Venturas Playground. All rights reserved.
+// Use of this source code is governed by the MIT license, a copy of which can
+// be found in the LICENSE file.
+
+#ifndef PLAYGROUND_BINDINGS_MODULE_CODE_CACHE_H_
+#define PLAYGROUND_BINDINGS_MODULE_CODE_CACHE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "base/file_path.h"
+#include "base/macros.h"
+
+namespace bindings {
+
+// Persistent on-disk cache for the code that v8 produced when compiling ES modules, which allows
+// subsequent server starts to skip parsing and compiling the modules. Each module has an entry in
+// the |directory|, keyed by its path, which is only valid for the exact same source code and
+// version of v8. Stale entries will be ignored when loading them, and overwritten when storing.
+class ModuleCodeCache {
+ public:
+  ModuleCodeCache(const base::FilePath& directory, const std::string& version);
+  ~ModuleCodeCache();
+
+  // Computes the hash of a module's |source|, which identifies the contents of cache entries.
+  static uint64_t ComputeSourceHash(const std::string& source);
+
+  // Loads the cached code for the module at |path| in to |data|. Returns whether a valid entry for
+  // the |source_hash| and the current version exists.
+  bool Load(const base::FilePath& path, uint64_t source_hash, std::vector<uint8_t>* data) const;
+
+  // Stores the |length| bytes of cached code in |data| for the module at |path|. Returns whether
+  // the entry could be written.
+  bool Store(const base::FilePath& path, uint64_t source_hash, const uint8_t* data, size_t length);
+
+  // Removes the entry for the module at |path|, for example because v8 rejected it.
+  void Remove(const base::FilePath& path);
+
+ private:
+  // Returns the path of the file in which the entry for the module at |path| is stored.
+  base::FilePath GetEntryPath(const base::FilePath& path) const;
+
+  base::FilePath directory_;
+  std::string version_;
+
+  DISALLOW_COPY_AND_ASSIGN(ModuleCodeCache);
+};
+
+}  // namespace bindings
+
+#endif  // PLAYGROUND_BINDINGS_MODULE_CODE_CACHE_H_
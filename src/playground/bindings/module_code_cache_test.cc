@@ -0,0 +1,50 @@
+// Copyright 2020 Las Venturas Playground. All rights reserved.
+// Use of this source code is governed by the MIT license, a copy of which can
+// be found in the LICENSE file.
+
+#include "bindings/module_code_cache.h"
+
+#include <boost/filesystem.hpp>
+
+#include "gtest/gtest.h"
+
+namespace fs = boost::filesystem;
+
+namespace bindings {
+
+TEST(ModuleCodeCacheTest, StoreAndLoad) {
+  const fs::path directory = fs::temp_directory_path() / fs::unique_path();
+  const base::FilePath cache_directory(directory.string());
+
+  const base::FilePath main_path("javascript/main.js");
+  const base::FilePath other_path("javascript/other.js");
+
+  const uint64_t source_hash = ModuleCodeCache::ComputeSourceHash("export default 42;");
+  const uint64_t changed_hash = ModuleCodeCache::ComputeSourceHash("export default 43;");
+  EXPECT_NE(source_hash, changed_hash);
+
+  const uint8_t code[] = { 1, 2, 3, 4, 5 };
+
+  ModuleCodeCache cache(cache_directory, "8.4.371");
+
+  std::vector<uint8_t> data;
+  EXPECT_FALSE(cache.Load(main_path, source_hash, &data));
+
+  EXPECT_TRUE(cache.Store(main_path, source_hash, code, sizeof(code)));
+  EXPECT_TRUE(cache.Load(main_path, source_hash, &data));
+  EXPECT_EQ(std::vector<uint8_t>(code, code + sizeof(code)), data);
+
+  // Entries are only valid for the same module, source code and version of v8.
+  EXPECT_FALSE(cache.Load(other_path, source_hash, &data));
+  EXPECT_FALSE(cache.Load(main_path, changed_hash, &data));
+
+  ModuleCodeCache other_version_cache(cache_directory, "8.5.0");
+  EXPECT_FALSE(other_version_cache.Load(main_path, source_hash, &data));
+
+  cache.Remove(main_path);
+  EXPECT_FALSE(cache.Load(main_path, source_hash, &data));
+
+  fs::remove_all(directory);
+}
+
+}  // namespace bindings
@@ -11,6 +11,8 @@
 #include "base/time.h"
 #include "bindings/modules/streamer/streamer_update.h"
 #include "bindings/modules/streamer/streamer_worker.h"
+#include "plugin/arguments.h"
+#include "plugin/callback.h"
 #include "plugin/plugin_controller.h"
 
 namespace bindings {
@@ -20,6 +22,9 @@ namespace {
 // Interval at which the streamer will update player positioning information.
 const double kStreamerUpdateIntervalMs = 250;
 
+// State of a player who is spectating, in which case they will not be tracked (PLAYER_STATE_SPECTATING).
+const int32_t kPlayerStateSpectating = 9;
+
 }  // namespace
 
 StreamerHost::StreamerHost(plugin::PluginController* plugin_controller,
@@ -103,9 +108,18 @@ void StreamerHost::OnFrame(double current_time) {
 
   last_update_time_ = current_time;
 
+  if (!ResolveNatives())
+    return;
+
   std::vector<StreamerUpdate> updates;
-  for (uint16_t playerid : tracked_players_) {
+  updates.reserve(tracked_players_.count());
+
+  for (uint16_t playerid = 0; playerid < kMaxPlayers; ++playerid) {
+    if (!tracked_players_[playerid])
+      continue;
+
     StreamerUpdate update;
+    update.playerid = playerid;
 
     GetPlayerPosition(playerid, (float**) &update.position);
 
@@ -121,8 +135,80 @@ void StreamerHost::OnFrame(double current_time) {
   tracked_players_invalidated_ = false;
 }
 
-void StreamerHost::SetTrackedPlayers(std::set<uint16_t> tracked_players) {
-  tracked_players_ = std::move(tracked_players);
+void StreamerHost::RegisterCallbacks(const std::vector<plugin::Callback>& callbacks) {
+  for (const auto& callback : callbacks) {
+    if (callback.name == "OnPlayerConnect")
+      on_player_connect_id_ = callback.id;
+    else if (callback.name == "OnPlayerDisconnect")
+      on_player_disconnect_id_ = callback.id;
+    else if (callback.name == "OnPlayerStateChange")
+      on_player_state_change_id_ = callback.id;
+  }
+}
+
+void StreamerHost::OnCallbackIntercepted(const plugin::Callback& callback,
+                                         const plugin::Arguments& arguments) {
+  if (callback.id != on_player_connect_id_ && callback.id != on_player_disconnect_id_ &&
+      callback.id != on_player_state_change_id_) {
+    return;
+  }
+
+  // By convention, the first argument of each of these callbacks is the playerid. The callbacks
+  // are declared in callbacks.txt, so verify that they have the expected arguments.
+  if (!arguments.size())
+    return;
+
+  const int32_t playerid = arguments.GetInteger(0);
+  if (playerid < 0 || playerid >= static_cast<int32_t>(kMaxPlayers))
+    return;
+
+  if (callback.id == on_player_connect_id_) {
+    untracked_players_.reset(playerid);
+    SetPlayerTracked(playerid, true);
+
+  } else if (callback.id == on_player_disconnect_id_) {
+    untracked_players_.reset(playerid);
+    SetPlayerTracked(playerid, false);
+
+  } else if (!untracked_players_[playerid] && arguments.size() >= 2) {
+    // OnPlayerStateChange(playerid, newstate, oldstate)
+    SetPlayerTracked(playerid, arguments.GetInteger(1) != kPlayerStateSpectating);
+  }
+}
+
+void StreamerHost::TrackPlayer(uint16_t playerid) {
+  if (playerid >= kMaxPlayers)
+    return;
+
+  untracked_players_.reset(playerid);
+  SetPlayerTracked(playerid, true);
+}
+
+void StreamerHost::UntrackPlayer(uint16_t playerid) {
+  if (playerid >= kMaxPlayers)
+    return;
+
+  untracked_players_.set(playerid);
+  SetPlayerTracked(playerid, false);
+}
+
+void StreamerHost::SetTrackedPlayers(const std::set<uint16_t>& tracked_players) {
+  tracked_players_.reset();
+  untracked_players_.reset();
+
+  for (uint16_t playerid : tracked_players) {
+    if (playerid < kMaxPlayers)
+      tracked_players_.set(playerid);
+  }
+
+  tracked_players_invalidated_ = true;
+}
+
+void StreamerHost::SetPlayerTracked(uint16_t playerid, bool tracked) {
+  if (tracked_players_[playerid] == tracked)
+    return;
+
+  tracked_players_[playerid] = tracked;
   tracked_players_invalidated_ = true;
 }
 
@@ -132,21 +218,32 @@ void StreamerHost::CallOnWorkerThread(boost::function<void()> function) {
   background_thread_io_context_.post(function);
 }
 
+bool StreamerHost::ResolveNatives() {
+  if (get_player_pos_id_ >= 0 && get_player_interior_id_ >= 0 && get_player_virtual_world_id_ >= 0)
+    return true;
+
+  get_player_pos_id_ = plugin_controller_->GetNativeId("GetPlayerPos");
+  get_player_interior_id_ = plugin_controller_->GetNativeId("GetPlayerInterior");
+  get_player_virtual_world_id_ = plugin_controller_->GetNativeId("GetPlayerVirtualWorld");
+
+  return get_player_pos_id_ >= 0 && get_player_interior_id_ >= 0 && get_player_virtual_world_id_ >= 0;
+}
+
 void StreamerHost::GetPlayerPosition(uint32_t playerid, float** position) const {
   void* arguments[4] = { &playerid, &position[0], &position[1], &position[2] };
-  plugin_controller_->CallFunction("GetPlayerPos", "irrr", (void**) &arguments);
+  plugin_controller_->CallFunction(get_player_pos_id_, "irrr", (void**) &arguments);
 }
 
 uint32_t StreamerHost::GetPlayerInteriorId(uint32_t playerid) const {
   void* arguments[1] = { &playerid };
   return static_cast<uint32_t>(
-      plugin_controller_->CallFunction("GetPlayerInterior", "i", (void**) &arguments));
+      plugin_controller_->CallFunction(get_player_interior_id_, "i", (void**) &arguments));
 }
 
 uint32_t StreamerHost::GetPlayerVirtualWorld(uint32_t playerid) const {
   void* arguments[1] = { &playerid };
   return static_cast<uint32_t>(
-      plugin_controller_->CallFunction("GetPlayerVirtualWorld", "i", (void**) &arguments));
+      plugin_controller_->CallFunction(get_player_virtual_world_id_, "i", (void**) &arguments));
 }
 
 }  // namespace streamer
@@ -5,15 +5,19 @@
 #ifndef PLAYGROUND_BINDINGS_MODULES_STREAMER_STREAMER_HOST_H_
 #define PLAYGROUND_BINDINGS_MODULES_STREAMER_STREAMER_HOST_H_
 
+#include <bitset>
 #include <boost/asio.hpp>
 #include <boost/function.hpp>
 #include <memory>
 #include <set>
 #include <stdint.h>
+#include <vector>
 
 #include "base/macros.h"
 
 namespace plugin {
+class Arguments;
+struct Callback;
 class PluginController;
 }
 
@@ -27,6 +31,9 @@ class StreamerWorker;
 // which runs on a background thread for performance reasons.
 class StreamerHost {
  public:
+  // Maximum number of players that can be tracked by the streamer (MAX_PLAYERS).
+  static constexpr size_t kMaxPlayers = 1000;
+
   StreamerHost(plugin::PluginController* plugin_controller,
                boost::asio::io_context& main_thread_io_context,
                boost::asio::io_context& background_thread_io_context);
@@ -58,15 +65,35 @@ class StreamerHost {
   // a particular cadence to be able to better understand positions.
   void OnFrame(double current_time);
 
-  // Sets the set of tracked player IDs for which the streamer has to cater. This is entirely
-  // controlled by JavaScript, which has knowledge of the connected players.
-  void SetTrackedPlayers(std::set<uint16_t> tracked_players);
+  // Registers the |callbacks| that will be intercepted, to identify those through which the set
+  // of tracked players is maintained: OnPlayerConnect, OnPlayerDisconnect and OnPlayerStateChange.
+  void RegisterCallbacks(const std::vector<plugin::Callback>& callbacks);
+
+  // Called when |callback| has been intercepted with the given |arguments|. Players are tracked
+  // automatically while they're connected to the server and not spectating.
+  void OnCallbackIntercepted(const plugin::Callback& callback, const plugin::Arguments& arguments);
+
+  // Explicitly starts or stops tracking |playerid|, overriding automatic tracking until the player
+  // disconnects from the server.
+  void TrackPlayer(uint16_t playerid);
+  void UntrackPlayer(uint16_t playerid);
+
+  // Sets the set of tracked player IDs for which the streamer has to cater, replacing both the
+  // automatically tracked players and any overrides.
+  void SetTrackedPlayers(const std::set<uint16_t>& tracked_players);
 
  private:
   // Calls the given |function| on the worker thread. All methods called on the StreamerWorker class
   // beyond the constructor must be called on that thread for data safety.
   void CallOnWorkerThread(boost::function<void()> function);
 
+  // Resolves the Ids of the native functions used by the host. Natives will only be available once
+  // they have been registered by the server, so this is repeated until it succeeds.
+  bool ResolveNatives();
+
+  // Updates whether |playerid| is being tracked by the streamer to |tracked|.
+  void SetPlayerTracked(uint16_t playerid, bool tracked);
+
   // Utility function to get the position of the given |playerid|. The |position| pointer must point
   // to an array being able to hold at least three floating point values.
   void GetPlayerPosition(uint32_t playerid, float** position) const;
@@ -79,6 +106,11 @@ class StreamerHost {
 
   plugin::PluginController* plugin_controller_;
 
+  // Ids of the native functions that will be called by the host.
+  int get_player_pos_id_ = -1;
+  int get_player_interior_id_ = -1;
+  int get_player_virtual_world_id_ = -1;
+
   boost::asio::io_context& main_thread_io_context_;
   boost::asio::io_context& background_thread_io_context_;
 
@@ -88,7 +120,16 @@ class StreamerHost {
   uint32_t last_streamer_id_ = 0;
   uint32_t last_entity_id_ = 0;
 
-  std::set<uint16_t> tracked_players_;
+  // Ids of the callbacks that maintain the set of tracked players, as assigned by the parser.
+  static constexpr size_t kInvalidCallbackId = static_cast<size_t>(-1);
+
+  size_t on_player_connect_id_ = kInvalidCallbackId;
+  size_t on_player_disconnect_id_ = kInvalidCallbackId;
+  size_t on_player_state_change_id_ = kInvalidCallbackId;
+
+  // Players that are being tracked, and players that were explicitly untracked by JavaScript.
+  std::bitset<kMaxPlayers> tracked_players_;
+  std::bitset<kMaxPlayers> untracked_players_;
   bool tracked_players_invalidated_ = false;
 
   double last_update_time_;
@@ -66,6 +66,47 @@ StreamerBindings* GetInstanceFromObject(v8::Local<v8::Object> object) {
   return static_cast<StreamerBindings*>(object->GetAlignedPointerFromInternalField(0));
 }
 
+// Reads the player Id from the first argument of the call to |function|. Returns whether a valid
+// player Id was read, throws an exception otherwise.
+bool ReadPlayerIdArgument(const v8::FunctionCallbackInfo<v8::Value>& arguments,
+                          const char* function, uint16_t* playerid) {
+  if (arguments.Length() < 1) {
+    ThrowException(std::string("unable to call ") + function +
+                   "(): 1 argument required, but none provided.");
+    return false;
+  }
+
+  if (!arguments[0]->IsNumber()) {
+    ThrowException(std::string("unable to call ") + function +
+                   "(): expected argument 1 to be a number.");
+    return false;
+  }
+
+  const double value = v8::Local<v8::Number>::Cast(arguments[0])->Value();
+  if (value < 0 || value >= streamer::StreamerHost::kMaxPlayers) {
+    ThrowException(std::string("unable to call ") + function +
+                   "(): expected argument 1 to be a valid player Id.");
+    return false;
+  }
+
+  *playerid = static_cast<uint16_t>(value);
+  return true;
+}
+
+// Streamer.trackPlayer(number playerId)
+void StreamerTrackPlayerCallback(const v8::FunctionCallbackInfo<v8::Value>& arguments) {
+  uint16_t playerid = 0;
+  if (ReadPlayerIdArgument(arguments, "trackPlayer", &playerid))
+    GetHost()->TrackPlayer(playerid);
+}
+
+// Streamer.untrackPlayer(number playerId)
+void StreamerUntrackPlayerCallback(const v8::FunctionCallbackInfo<v8::Value>& arguments) {
+  uint16_t playerid = 0;
+  if (ReadPlayerIdArgument(arguments, "untrackPlayer", &playerid))
+    GetHost()->UntrackPlayer(playerid);
+}
+
 // Streamer.setTrackedPlayers(Set playerIds)
 void StreamerSetTrackedPlayersCallback(const v8::FunctionCallbackInfo<v8::Value>& arguments) {
   if (arguments.Length() < 1) {
@@ -95,12 +136,12 @@ void StreamerSetTrackedPlayersCallback(const v8::FunctionCallbackInfo<v8::Value>
       v8::Local<v8::Number> entry_number = v8::Local<v8::Number>::Cast(entry);
       double entry_double = entry_number->Value();
 
-      if (entry_double >= 0 && entry_double <= 1000)
+      if (entry_double >= 0 && entry_double < streamer::StreamerHost::kMaxPlayers)
         players.insert(static_cast<uint16_t>(entry_double));
     }
   }
 
-  Runtime::FromIsolate(arguments.GetIsolate())->GetStreamerHost()->SetTrackedPlayers(std::move(players));
+  Runtime::FromIsolate(arguments.GetIsolate())->GetStreamerHost()->SetTrackedPlayers(players);
 }
 
 // Streamer.prototype.constructor(number maxVisible, number streamDistance = 300)
@@ -257,6 +298,8 @@ void StreamerModule::InstallPrototypes(v8::Local<v8::ObjectTemplate> global) {
 
   v8::Local<v8::FunctionTemplate> function_template = v8::FunctionTemplate::New(isolate, StreamerConstructorCallback);
   function_template->Set(v8String("setTrackedPlayers"), v8::FunctionTemplate::New(isolate, StreamerSetTrackedPlayersCallback));
+  function_template->Set(v8String("trackPlayer"), v8::FunctionTemplate::New(isolate, StreamerTrackPlayerCallback));
+  function_template->Set(v8String("untrackPlayer"), v8::FunctionTemplate::New(isolate, StreamerUntrackPlayerCallback));
 
   v8::Local<v8::ObjectTemplate> instance_template = function_template->InstanceTemplate();
   instance_template->SetInternalFieldCount(1 /** for the native instance **/);
@@ -16,6 +16,8 @@ namespace bindings {
 // [Constructor(number maxVisible, number streamingDistance = 300)]
 // interface Streamer {
 //     static setTrackedPlayers(Set playerIds);
+//     static trackPlayer(number playerId);
+//     static untrackPlayer(number playerId);
 //
 //     number add(number x, number y, number z);
 //     void optimise();
@@ -24,6 +26,9 @@ namespace bindings {
 //     Promise<sequence<number>> stream();
 // };
 //
+// Players are tracked automatically while they're connected to the server and not spectating. The
+// trackPlayer() and untrackPlayer() methods override this until the player disconnects.
+//
 // The Streamer interface should only rarely be used directly. Instead, use the slightly higher-
 // level implementations available in //features/streamer/.
 class StreamerModule {
@@ -4,7 +4,10 @@
 
 #include "bindings/pawn_invoke.h"
 
+#include <ctype.h>
 #include <string.h>
+#include <algorithm>
+#include <vector>
 
 #include "base/logging.h"
 #include "bindings/provided_natives.h"
@@ -12,6 +15,7 @@
 #include "bindings/utilities.h"
 #include "performance/scoped_trace.h"
 #include "plugin/plugin_controller.h"
+#include "plugin/string_marshalling.h"
 
 namespace bindings {
 
@@ -29,15 +33,42 @@ enum SignatureType {
   SIGNATURE_TYPE_STRING_REFERENCE
 };
 
+// Types that the return value of a native can be interpreted as. Pawn natives always return a
+// cell, which will be reinterpreted according to the return type given in the signature.
+enum ReturnType {
+  RETURN_TYPE_BOOL,
+  RETURN_TYPE_FLOAT,
+  RETURN_TYPE_INT
+};
+
+// Converts the |result| of a native invocation to a JavaScript value based on the |return_type|.
+v8::Local<v8::Value> ConvertReturnValue(v8::Isolate* isolate, ReturnType return_type, int result) {
+  switch (return_type) {
+  case RETURN_TYPE_BOOL:
+    return v8::Boolean::New(isolate, result != 0);
+  case RETURN_TYPE_FLOAT:
+    return v8::Number::New(isolate, *reinterpret_cast<float*>(&result));
+  case RETURN_TYPE_INT:
+    break;
+  }
+
+  return v8::Number::New(isolate, static_cast<double>(result));
+}
+
 }  // namespace
 
 // Buffer in which we store the data associated with each invocation. This significantly reduces
-// the need to do many allocations for each function invocation, at the expense of a little bit
-// of memory usage.
+// the need to do many allocations for each function invocation. Strings and arrays are stored in
+// arenas that grow on demand, and retain their capacity for subsequent invocations.
 struct PawnInvoke::StaticBuffer {
+  // Type and, for string references, capacity of each of the entries in the signature.
   SignatureType signature[PawnInvoke::kMaxArgumentCount];
+  size_t string_capacity[PawnInvoke::kMaxArgumentCount];
+
+  // Type as which the return value of the native should be interpreted.
+  ReturnType return_type;
 
-  char arguments_format[PawnInvoke::kMaxArgumentCount];
+  char arguments_format[PawnInvoke::kMaxArgumentCount + 1];
   void* arguments[PawnInvoke::kMaxArgumentCount];
   
   // Integer and floating point values will both be stored in the same buffer, but we must be
@@ -45,48 +76,106 @@ struct PawnInvoke::StaticBuffer {
   static_assert(sizeof(float) == sizeof(int), "Expected sizeof(float) == sizeof(int).");
   int number_values[PawnInvoke::kMaxArgumentCount];
 
-  // Maximum length of a string stored in the static buffer. Total memory required for this is
-  // kMaxArgumentCount (24) * kMaxStringLength (3072) = 72 KiB.
-  static const size_t kMaxStringLength = 3072;
+  // Capacity of string reference arguments for which no capacity has been given in the signature.
+  static const size_t kDefaultStringLength = 3072;
+
+  // Arena in which the string and array values are stored. Growing the arena invalidates pointers
+  // in to it, so the offsets are stored until the invocation's arguments have been finalized.
+  std::vector<int> arena;
+  size_t arena_size = 0;
+
+  bool is_arena_value[PawnInvoke::kMaxArgumentCount];
+  size_t arena_offsets[PawnInvoke::kMaxArgumentCount];
+
+  // Prepares the buffer for a new invocation. The arena's memory will be reused.
+  void Reset() {
+    arena_size = 0;
+    memset(is_arena_value, 0, sizeof(is_arena_value));
+  }
+
+  // Allocates |size| bytes in the arena for the argument at |index|, and returns a pointer to it.
+  // The pointer is only valid until the next allocation.
+  char* Allocate(size_t index, size_t size) {
+    const size_t offset = arena_size;
+
+    arena_size += (size + sizeof(int) - 1) / sizeof(int);
+    if (arena.size() < arena_size)
+      arena.resize(std::max(arena_size, arena.size() * 2));
+
+    is_arena_value[index] = true;
+    arena_offsets[index] = offset;
 
-  char string_values[PawnInvoke::kMaxArgumentCount][kMaxStringLength];
+    return reinterpret_cast<char*>(&arena[offset]);
+  }
+
+  // Returns a pointer to the arena memory allocated for the argument at |index|.
+  char* Get(size_t index) {
+    return reinterpret_cast<char*>(&arena[arena_offsets[index]]);
+  }
 
-  // Maximum number of entries in an array. The total memory required for this buffer is
-  // kMaxArgumentCount (24) * kMaxArrayLength (144) * sizeof(int) = 13.5 KiB.
-  static const size_t kMaxArrayLength = 144;
+  // Writes the |string| to the arena for the argument at |index|.
+  void WriteString(v8::Isolate* isolate, size_t index, v8::Local<v8::String> string) {
+    const int length = string->Length();
 
-  int array_values[PawnInvoke::kMaxArgumentCount][kMaxArrayLength];
+    char* data = Allocate(index, length + 1);
+    string->WriteOneByte(isolate, reinterpret_cast<uint8_t*>(data), 0, length);
+    data[length] = 0;
+  }
+
+  // Points the arguments stored in the arena to their final location. Must be called after all
+  // arguments have been written, and before the invocation is made.
+  void FinalizeArguments(size_t argument_count) {
+    for (size_t index = 0; index < argument_count; ++index) {
+      if (is_arena_value[index])
+        arguments[index] = Get(index);
+    }
+  }
 };
 
 PawnInvoke::PawnInvoke(plugin::PluginController* plugin_controller)
-    : static_buffer_(static_cast<StaticBuffer*>(calloc(1, sizeof(StaticBuffer)))),
+    : static_buffer_(new StaticBuffer),
       plugin_controller_(plugin_controller) {}
 
 PawnInvoke::~PawnInvoke() = default;
 
 v8::Local<v8::Value> PawnInvoke::Call(const v8::FunctionCallbackInfo<v8::Value>& arguments) {
   DCHECK(arguments.Length() >= 1);
-  DCHECK(arguments[0]->IsString());
+  DCHECK(arguments[0]->IsString() || arguments[0]->IsInt32());
 
   v8::Isolate* isolate = arguments.GetIsolate();
+  v8::Local<v8::Context> context = isolate->GetCurrentContext();
 
-  // The first argument contains the name of the function that should be invoked.
-  const std::string function = toString(arguments[0]);
+  int native_id = -1;
+  std::string function;
 
-  if (!function.length()) {
-    ThrowException("unable to execute pawnInvoke(): the function name must not be empty.");
-    return v8::Local<v8::Value>();
-  }
+  // The first argument contains either the Id or the name of the function that should be invoked.
+  if (arguments[0]->IsInt32()) {
+    native_id = arguments[0]->Int32Value(context).ToChecked();
+    if (native_id < 0) {
+      ThrowException("unable to execute pawnInvoke(): the native Id must not be negative.");
+      return v8::Local<v8::Value>();
+    }
+  } else {
+    function = toString(arguments[0]);
+    if (!function.length()) {
+      ThrowException("unable to execute pawnInvoke(): the function name must not be empty.");
+      return v8::Local<v8::Value>();
+    }
 
-  // Issue a warning when pawnInvoke() is used for a native that is not provided by JavaScript
-  // before the tests have finished running, because tests should not rely on the Pawn code.
-  if (!Runtime::FromIsolate(isolate)->IsReady() && !ProvidedNatives::GetInstance()->IsProvided(function))
-    LOG(WARNING) << "Called Pawn function " << function << " whilst running the JavaScript tests.";
+    // Issue a warning when pawnInvoke() is used for a native that is not provided by JavaScript
+    // before the tests have finished running, because tests should not rely on the Pawn code.
+    if (!Runtime::FromIsolate(isolate)->IsReady() && !ProvidedNatives::GetInstance()->IsProvided(function))
+      LOG(WARNING) << "Called Pawn function " << function << " whilst running the JavaScript tests.";
+  }
 
   // Fast-path for functions that don't take any arguments at all. Immediately invoke the native on
   // the SA-MP server and return whatever it returned to us.
-  if (arguments.Length() == 1)
-    return v8::Number::New(isolate, plugin_controller_->CallFunction(function));
+  if (arguments.Length() == 1) {
+    const int result = native_id >= 0 ? plugin_controller_->CallFunction(native_id)
+                                      : plugin_controller_->CallFunction(function);
+
+    return v8::Number::New(isolate, result);
+  }
 
   if (!arguments[1]->IsString()) {
     ThrowException("unable to execute pawnInvoke(): expected a string for argument 2.");
@@ -114,46 +203,89 @@ v8::Local<v8::Value> PawnInvoke::Call(const v8::FunctionCallbackInfo<v8::Value>&
     return v8::Local<v8::Value>();
   }
 
-  size_t argument_offset = 0;
+  static_buffer_->Reset();
 
-  v8::Local<v8::Context> context = isolate->GetCurrentContext();
+  // The Pawn argument count may not match the JavaScript one, since we substitute the allowed
+  // length for string reference arguments automatically.
+  size_t pawn_argument_count = 0;
 
   // Iterate over each of the arguments to verify their types and to set pointers accordingly.
   for (size_t signature_index = 0; signature_index < signature_length; ++signature_index) {
-    size_t argument = signature_index + argument_offset;
-    size_t index = argument + 2;
+    // String references take two Pawn arguments, as their capacity will be passed as well.
+    const size_t required_arguments =
+        static_buffer_->signature[signature_index] == SIGNATURE_TYPE_STRING_REFERENCE ? 2 : 1;
+
+    if (pawn_argument_count + required_arguments > kMaxArgumentCount) {
+      ThrowException("unable to execute pawnInvoke(): too many arguments.");
+      return v8::Local<v8::Value>();
+    }
+
+    const size_t argument = pawn_argument_count++;
+    const size_t index = signature_index + 2;
 
     bool type_mismatch = false;
-    switch (static_buffer_->signature[argument]) {
+    switch (static_buffer_->signature[signature_index]) {
     case SIGNATURE_TYPE_ARRAY:
       if (type_mismatch = !arguments[index]->IsArray())
         break;
 
       {
-        int* array_data = static_buffer_->array_values[argument];
-        size_t array_length = 0;
-
         v8::Local<v8::Array> js_array = v8::Local<v8::Array>::Cast(arguments[index]);
         uint32_t js_length = js_array->Length();
 
-        for (uint32_t index = 0; index < js_length; ++index) {
-          v8::MaybeLocal<v8::Value> maybe_entry = js_array->Get(context, index);
-          if (maybe_entry.IsEmpty())
+        // The array's size is passed in a later argument, which the native will rely on. Make sure
+        // that the buffer is able to hold at least that many values. The offset to that argument
+        // is determined in the same way as the native function manager will when invoking it.
+        const int array_native_id =
+            native_id >= 0 ? native_id : plugin_controller_->GetNativeId(function);
+        const size_t size_argument =
+            argument + plugin_controller_->GetArraySizeOffset(array_native_id, argument);
+
+        uint32_t capacity = std::max(js_length, 1u);
+
+        size_t pawn_argument = argument;
+        for (size_t size_index = signature_index; size_index < signature_length; ++size_index) {
+          if (pawn_argument > size_argument)
+            break;
+
+          if (pawn_argument == size_argument &&
+              static_buffer_->signature[size_index] == SIGNATURE_TYPE_INT &&
+              arguments[size_index + 2]->IsNumber()) {
+            const int32_t size = arguments[size_index + 2]->Int32Value(context).ToChecked();
+            if (size > 0 && static_cast<size_t>(size) > kMaxBufferCapacity) {
+              ThrowException("unable to execute pawnInvoke(): array size too large for argument " +
+                             std::to_string(size_index + 2));
+              return v8::Local<v8::Value>();
+            }
+
+            if (size > 0)
+              capacity = std::max(capacity, static_cast<uint32_t>(size));
+          }
+
+          pawn_argument +=
+              static_buffer_->signature[size_index] == SIGNATURE_TYPE_STRING_REFERENCE ? 2 : 1;
+        }
+
+        int* array_data = reinterpret_cast<int*>(
+            static_buffer_->Allocate(argument, capacity * sizeof(int)));
+
+        if (capacity > js_length)
+          memset(array_data + js_length, 0, (capacity - js_length) * sizeof(int));
+
+        for (uint32_t array_index = 0; array_index < js_length; ++array_index) {
+          v8::MaybeLocal<v8::Value> maybe_entry = js_array->Get(context, array_index);
+          if (maybe_entry.IsEmpty()) {
+            array_data[array_index] = 0;
             continue;
+          }
 
           v8::Local<v8::Value> entry = maybe_entry.ToLocalChecked();
           if (type_mismatch = !entry->IsNumber())
             break;
 
-          if (array_length >= PawnInvoke::StaticBuffer::kMaxArrayLength) {
-            ThrowException("unable to execute pawnInvoke(): too many array values for argument " +
-                           std::to_string(index));
-          }
-
-          array_data[array_length++] = entry->Int32Value(context).ToChecked();
+          array_data[array_index] = entry->Int32Value(context).ToChecked();
         }
 
-        static_buffer_->arguments[argument] = array_data;
         static_buffer_->arguments_format[argument] = 'a';
       }
 
@@ -201,34 +333,29 @@ v8::Local<v8::Value> PawnInvoke::Call(const v8::FunctionCallbackInfo<v8::Value>&
           return v8::Local<v8::Value>();
         }
 
-        v8::Local<v8::String> string = maybe.ToLocalChecked();
-        if (string->Length() >= StaticBuffer::kMaxStringLength) {
-          ThrowException("unable to execute pawnInvoke(): string overflow for argument " +
-                           std::to_string(index));
-
-          return v8::Local<v8::Value>();
-        }
-
-        string->WriteOneByte(
-            isolate, (uint8_t*)&static_buffer_->string_values[argument], 0, string->Length());
-
-        static_buffer_->string_values[argument][string->Length()] = 0;
+        static_buffer_->WriteString(isolate, argument, maybe.ToLocalChecked());
       }
 
-      static_buffer_->arguments[argument] = &static_buffer_->string_values[argument];
       static_buffer_->arguments_format[argument] = 's';
       break;
 
     case SIGNATURE_TYPE_STRING_REFERENCE:
-      static_buffer_->arguments[argument] = &static_buffer_->string_values[argument];
-      static_buffer_->arguments_format[argument] = 'a';
+      {
+        const size_t capacity = static_buffer_->string_capacity[signature_index];
 
-      ++argument_offset;
-      ++argument;
+        // The buffer is passed as an array of |capacity| cells, which will be copied to the heap of
+        // the fake AMX, so it must be able to hold that many cells rather than characters.
+        char* data = static_buffer_->Allocate(argument, capacity * sizeof(int));
+        reinterpret_cast<int*>(data)[0] = 0;
 
-      static_buffer_->number_values[argument] = StaticBuffer::kMaxStringLength;
-      static_buffer_->arguments[argument] = &static_buffer_->number_values[argument];
-      static_buffer_->arguments_format[argument] = 'i';
+        static_buffer_->arguments_format[argument] = 'a';
+
+        const size_t length_argument = pawn_argument_count++;
+
+        static_buffer_->number_values[length_argument] = static_cast<int>(capacity);
+        static_buffer_->arguments[length_argument] = &static_buffer_->number_values[length_argument];
+        static_buffer_->arguments_format[length_argument] = 'i';
+      }
       break;
     }
 
@@ -242,24 +369,40 @@ v8::Local<v8::Value> PawnInvoke::Call(const v8::FunctionCallbackInfo<v8::Value>&
     }
   }
 
-  // The Pawn argument count may not match the JavaScript one, since we substitute the allowed
-  // length for string reference arguments automatically.
-  const size_t pawn_argument_count = signature_length + argument_offset;
-
   // Make sure that the argument format string is zero-terminated.
   static_buffer_->arguments_format[pawn_argument_count] = 0;
   DCHECK(strlen(static_buffer_->arguments_format) == pawn_argument_count);
 
+  // Now that the arena won't grow anymore, point the arguments to their values stored in it.
+  static_buffer_->FinalizeArguments(pawn_argument_count);
+
   // Invoke the native SA-MP function. We simply pass the assembled argument format and the
   // array of void* pointers to the intended arguments to the function itself.
-  int result = plugin_controller_->CallFunction(function,
-                                                static_buffer_->arguments_format,
-                                                static_buffer_->arguments);
+  //
+  // Natives may legitimately return -1, which is also the internal error code used when a function
+  // cannot be invoked, so whether the call succeeded is reported separately.
+  int result = 0;
+  bool success = false;
+
+  if (native_id >= 0) {
+    result = plugin_controller_->CallFunction(native_id,
+                                              static_buffer_->arguments_format,
+                                              static_buffer_->arguments,
+                                              &success);
+  } else {
+    result = plugin_controller_->CallFunction(function,
+                                              static_buffer_->arguments_format,
+                                              static_buffer_->arguments,
+                                              &success);
+  }
 
-  // If there are no explicit return values, simply return the |result|.
-  if (!return_count || result == -1 /** internal error code **/)
+  if (!success)
     return v8::Number::New(isolate, static_cast<double>(result));
 
+  // If there are no explicit return values, return the |result| interpreted as the return type.
+  if (!return_count)
+    return ConvertReturnValue(isolate, static_buffer_->return_type, result);
+
   // We want to eagerly return a value immediately if there is only one return value. In all other
   // cases, the return values will be stored in an array, and the array will be returned.
   const bool eager_return = (return_count == 1);
@@ -269,55 +412,303 @@ v8::Local<v8::Value> PawnInvoke::Call(const v8::FunctionCallbackInfo<v8::Value>&
     return_array = v8::Array::New(isolate, return_count);
 
   size_t stored_return_values = 0;
+  size_t argument = 0;
 
-  // Iterate over the arguments again to find those which were passed as a reference. Those will
-  // be considered return values of the JavaScript function.
-  for (size_t argument = 0; argument < pawn_argument_count; ++argument) {
+  // Iterate over the signature again to find the arguments which were passed as a reference. Those
+  // will be considered return values of the JavaScript function.
+  for (size_t signature_index = 0; signature_index < signature_length; ++signature_index, ++argument) {
     v8::Local<v8::Value> value;
 
-    switch (static_buffer_->signature[argument]) {
+    switch (static_buffer_->signature[signature_index]) {
+    case SIGNATURE_TYPE_ARRAY:
     case SIGNATURE_TYPE_FLOAT:
     case SIGNATURE_TYPE_INT:
     case SIGNATURE_TYPE_STRING:
-      break;
+      continue;
 
     case SIGNATURE_TYPE_FLOAT_REFERENCE:
       value = v8::Number::New(isolate,
                               *reinterpret_cast<float*>(&static_buffer_->number_values[argument]));
-
-      if (eager_return)
-        return value;
-
-      return_array->Set(context, stored_return_values++, value);
       break;
+
     case SIGNATURE_TYPE_INT_REFERENCE:
       value = v8::Number::New(isolate, static_buffer_->number_values[argument]);
-      if (eager_return)
-        return value;
-
-      return_array->Set(context, stored_return_values++, value);
       break;
+
     case SIGNATURE_TYPE_STRING_REFERENCE:
       {
-        v8::MaybeLocal<v8::String> maybe =
-            v8::String::NewFromUtf8(isolate,
-                                    static_buffer_->string_values[argument], v8::NewStringType::kNormal);
+        // Natives do not consistently return the length of the string they wrote, so determine it
+        // based on the buffer, bounded by the capacity that was advertised to the native.
+        const char* data = static_buffer_->Get(argument);
+        const size_t length = strnlen(data, static_buffer_->string_capacity[signature_index]);
+
+        // Most strings only contain ASCII characters, which don't have to be decoded as UTF-8.
+        v8::MaybeLocal<v8::String> maybe;
+        if (plugin::IsAsciiString(data, length)) {
+          maybe = v8::String::NewFromOneByte(isolate, reinterpret_cast<const uint8_t*>(data),
+                                             v8::NewStringType::kNormal, static_cast<int>(length));
+        } else {
+          maybe = v8::String::NewFromUtf8(isolate, data, v8::NewStringType::kNormal,
+                                          static_cast<int>(length));
+        }
 
         if (maybe.IsEmpty())
           value = v8::Null(isolate);
         else
           value = maybe.ToLocalChecked();
+
+        ++argument;  // skip the implicit length argument
       }
+      break;
+    }
+
+    if (eager_return)
+      return value;
+
+    return_array->Set(context, stored_return_values++, value);
+  }
+
+  return return_array;
+}
+
+void PawnInvoke::CallDeferred(const v8::FunctionCallbackInfo<v8::Value>& arguments) {
+  v8::Isolate* isolate = arguments.GetIsolate();
+  v8::Local<v8::Context> context = isolate->GetCurrentContext();
+
+  if (arguments.Length() < 2 || !arguments[1]->IsString()) {
+    ThrowException("unable to execute pawnInvokeDeferred(): expected a string for argument 2.");
+    return;
+  }
+
+  // Resolve the native that should be invoked, either by its Id or by its name.
+  int native_id = -1;
+  if (arguments[0]->IsInt32()) {
+    native_id = arguments[0]->Int32Value(context).ToChecked();
+
+    // Deferred calls are executed after this call returns, so invalid Ids must be caught now.
+    if (!plugin_controller_->IsValidNativeId(native_id)) {
+      ThrowException("unable to execute pawnInvokeDeferred(): unknown native Id: " +
+                     std::to_string(native_id));
+      return;
+    }
+  } else {
+    const std::string function = toString(arguments[0]);
+    native_id = plugin_controller_->GetNativeId(function);
+
+    if (native_id < 0) {
+      ThrowException("unable to execute pawnInvokeDeferred(): unknown native: " + function);
+      return;
+    }
+  }
+
+  const std::string signature = toString(arguments[1]);
+
+  size_t offset = 0;
+  bool supersede = false;
+
+  if (signature.length() && signature[0] == '=') {
+    supersede = true;
+    offset = 1;
+  }
+
+  const size_t argument_count = signature.length() - offset;
+  if (argument_count >= kMaxArgumentCount) {
+    ThrowException("unable to execute pawnInvokeDeferred(): too many arguments.");
+    return;
+  }
+
+  if (arguments.Length() != argument_count + 2) {
+    ThrowException("unable to execute pawnInvokeDeferred(): " +
+                   std::to_string(argument_count + 2) + " arguments required, but " +
+                   std::to_string(arguments.Length()) + " provided.");
+    return;
+  }
+
+  static_buffer_->Reset();
 
-      if (eager_return)
-        return value;
+  for (size_t argument = 0; argument < argument_count; ++argument) {
+    const char type = signature[argument + offset];
+    const size_t index = argument + 2;
 
-      return_array->Set(context, stored_return_values++, value);
+    switch (type) {
+    case 'f':
+    case 'i':
+      if (!arguments[index]->IsNumber()) {
+        ThrowException("unable to execute pawnInvokeDeferred(): type mismatch for argument " +
+                       std::to_string(index) + ".");
+        return;
+      }
+
+      if (type == 'f') {
+        float float_value = static_cast<float>(arguments[index]->NumberValue(context).ToChecked());
+        static_buffer_->number_values[argument] = *reinterpret_cast<int*>(&float_value);
+      } else {
+        static_buffer_->number_values[argument] = arguments[index]->Int32Value(context).ToChecked();
+      }
+
+      static_buffer_->arguments[argument] = &static_buffer_->number_values[argument];
+      break;
+
+    case 's':
+      {
+        v8::MaybeLocal<v8::String> maybe = arguments[index]->ToString(context);
+        if (maybe.IsEmpty()) {
+          ThrowException("unable to execute pawnInvokeDeferred(): unable to convert argument " +
+                         std::to_string(index) + " to a string.");
+          return;
+        }
+
+        static_buffer_->WriteString(isolate, argument, maybe.ToLocalChecked());
+      }
       break;
+
+    default:
+      ThrowException("unable to execute pawnInvokeDeferred(): unsupported argument type: " +
+                     std::string(1, type));
+      return;
     }
+
+    static_buffer_->arguments_format[argument] = type;
   }
 
-  return return_array;
+  static_buffer_->arguments_format[argument_count] = 0;
+  static_buffer_->FinalizeArguments(argument_count);
+
+  if (!plugin_controller_->CallFunctionDeferred(native_id, static_buffer_->arguments_format,
+                                                static_buffer_->arguments, supersede)) {
+    ThrowException("unable to execute pawnInvokeDeferred(): the call could not be queued.");
+  }
+}
+
+v8::Local<v8::Value> PawnInvoke::CallPublicBatch(
+    const v8::FunctionCallbackInfo<v8::Value>& arguments) {
+  v8::Isolate* isolate = arguments.GetIsolate();
+  v8::Local<v8::Context> context = isolate->GetCurrentContext();
+
+  if (!arguments[0]->IsString()) {
+    ThrowException("unable to execute callPublicBatch(): expected a string for argument 1.");
+    return v8::Local<v8::Value>();
+  }
+
+  if (!arguments[1]->IsString()) {
+    ThrowException("unable to execute callPublicBatch(): expected a string for argument 2.");
+    return v8::Local<v8::Value>();
+  }
+
+  if (!arguments[2]->IsArray()) {
+    ThrowException("unable to execute callPublicBatch(): expected an array for argument 3.");
+    return v8::Local<v8::Value>();
+  }
+
+  const std::string function = toString(arguments[0]);
+  const std::string format = toString(arguments[1]);
+
+  if (format.empty() || format.length() > kMaxArgumentCount) {
+    ThrowException("unable to execute callPublicBatch(): the format must have between 1 and " +
+                   std::to_string(kMaxArgumentCount) + " arguments.");
+    return v8::Local<v8::Value>();
+  }
+
+  v8::Local<v8::Array> packed_arguments = v8::Local<v8::Array>::Cast(arguments[2]);
+
+  const size_t value_count = packed_arguments->Length();
+  const size_t count = value_count / format.length();
+
+  if (value_count % format.length() != 0) {
+    ThrowException("unable to execute callPublicBatch(): the number of arguments must be a "
+                   "multiple of the format's length.");
+    return v8::Local<v8::Value>();
+  }
+
+  if (count > kMaxBatchSize) {
+    ThrowException("unable to execute callPublicBatch(): no more than " +
+                   std::to_string(kMaxBatchSize) + " invocations may be batched.");
+    return v8::Local<v8::Value>();
+  }
+
+  // Storage for the arguments is local to this call: the public functions may call back in to
+  // JavaScript, which could start another batch while this one is still being executed. Strings
+  // are written to the |batch_strings| arena, and will be referred to by their offset until all
+  // of them have been written.
+  std::vector<int> batch_values(value_count);
+  std::vector<void*> batch_arguments(value_count);
+  std::vector<char> batch_strings;
+
+  for (size_t index = 0; index < value_count; ++index) {
+    const char type = format[index % format.length()];
+
+    v8::Local<v8::Value> value;
+    if (!packed_arguments->Get(context, static_cast<uint32_t>(index)).ToLocal(&value))
+      return v8::Local<v8::Value>();
+
+    switch (type) {
+    case 'f':
+    case 'i':
+      if (!value->IsNumber()) {
+        ThrowException("unable to execute callPublicBatch(): type mismatch for packed argument " +
+                       std::to_string(index) + ".");
+        return v8::Local<v8::Value>();
+      }
+
+      if (type == 'f') {
+        float float_value = static_cast<float>(value->NumberValue(context).ToChecked());
+        batch_values[index] = *reinterpret_cast<int*>(&float_value);
+      } else {
+        batch_values[index] = value->Int32Value(context).ToChecked();
+      }
+
+      batch_arguments[index] = &batch_values[index];
+      break;
+
+    case 's':
+      {
+        v8::Local<v8::String> string;
+        if (!value->ToString(context).ToLocal(&string)) {
+          ThrowException("unable to execute callPublicBatch(): unable to convert packed argument " +
+                         std::to_string(index) + " to a string.");
+          return v8::Local<v8::Value>();
+        }
+
+        const size_t offset = batch_strings.size();
+        const int length = string->Length();
+
+        batch_strings.resize(offset + length + 1);
+        string->WriteOneByte(isolate, reinterpret_cast<uint8_t*>(&batch_strings[offset]), 0, length);
+        batch_strings[offset + length] = 0;
+
+        // Growing the arena invalidates pointers in to it, so store the offset for now.
+        batch_values[index] = static_cast<int>(offset);
+        batch_arguments[index] = nullptr;
+      }
+      break;
+
+    default:
+      ThrowException("unable to execute callPublicBatch(): unsupported argument type: " +
+                     std::string(1, type));
+      return v8::Local<v8::Value>();
+    }
+  }
+
+  // Point the string arguments to their final location in the arena.
+  for (size_t index = 0; index < value_count; ++index) {
+    if (!batch_arguments[index])
+      batch_arguments[index] = &batch_strings[batch_values[index]];
+  }
+
+  v8::Local<v8::ArrayBuffer> buffer = v8::ArrayBuffer::New(isolate, count * sizeof(int32_t));
+  int32_t* results = static_cast<int32_t*>(buffer->GetBackingStore()->Data());
+
+  if (!plugin_controller_->CallPublicBatch(function, format.c_str(), batch_arguments.data(),
+                                           count, results)) {
+    ThrowException("unable to execute callPublicBatch(): unable to call " + function + ".");
+    return v8::Local<v8::Value>();
+  }
+
+  return v8::Int32Array::New(buffer, 0, count);
+}
+
+int PawnInvoke::GetNativeId(const std::string& function_name) {
+  return plugin_controller_->GetNativeId(function_name);
 }
 
 bool PawnInvoke::ParseSignature(v8::Local<v8::Value> signature,
@@ -325,8 +716,32 @@ bool PawnInvoke::ParseSignature(v8::Local<v8::Value> signature,
   v8::String::Utf8Value string(GetIsolate(), signature);
   DCHECK(*string);
 
+  size_t signature_index = 0;
+  int index = 0;
+
+  // The signature may be prefixed with the return type of the native, for example 'f:fff'.
+  static_buffer_->return_type = RETURN_TYPE_INT;
+  if (string.length() >= 2 && (*string)[1] == ':') {
+    switch ((*string)[0]) {
+    case 'b':
+      static_buffer_->return_type = RETURN_TYPE_BOOL;
+      break;
+    case 'f':
+      static_buffer_->return_type = RETURN_TYPE_FLOAT;
+      break;
+    case 'i':
+      static_buffer_->return_type = RETURN_TYPE_INT;
+      break;
+    default:
+      // The return type passed in the signature is unknown.
+      return false;
+    }
+
+    index = 2;
+  }
+
   bool found_reference = false;
-  for (int index = 0; index < string.length(); ++index) {
+  for (; index < string.length(); ++index) {
     const char type = (*string)[index];
     const bool is_reference = type == 'F' || type == 'I' || type == 'S';
 
@@ -336,39 +751,57 @@ bool PawnInvoke::ParseSignature(v8::Local<v8::Value> signature,
 
     found_reference |= is_reference;
 
+    if (signature_index >= kMaxArgumentCount)
+      return false;
+
     switch (type) {
     case 'a':
-      static_buffer_->signature[index] = SignatureType::SIGNATURE_TYPE_ARRAY;
+      static_buffer_->signature[signature_index] = SignatureType::SIGNATURE_TYPE_ARRAY;
       *argument_count += 1;
       break;
     case 'f':
-      static_buffer_->signature[index] = SignatureType::SIGNATURE_TYPE_FLOAT;
+      static_buffer_->signature[signature_index] = SignatureType::SIGNATURE_TYPE_FLOAT;
       *argument_count += 1;
       break;
     case 'F':
-      static_buffer_->signature[index] = SignatureType::SIGNATURE_TYPE_FLOAT_REFERENCE;
+      static_buffer_->signature[signature_index] = SignatureType::SIGNATURE_TYPE_FLOAT_REFERENCE;
       *return_count += 1;
       break;
     case 'i':
-      static_buffer_->signature[index] = SignatureType::SIGNATURE_TYPE_INT;
+      static_buffer_->signature[signature_index] = SignatureType::SIGNATURE_TYPE_INT;
       *argument_count += 1;
       break;
     case 'I':
-      static_buffer_->signature[index] = SignatureType::SIGNATURE_TYPE_INT_REFERENCE;
+      static_buffer_->signature[signature_index] = SignatureType::SIGNATURE_TYPE_INT_REFERENCE;
       *return_count += 1;
       break;
     case 's':
-      static_buffer_->signature[index] = SignatureType::SIGNATURE_TYPE_STRING;
+      static_buffer_->signature[signature_index] = SignatureType::SIGNATURE_TYPE_STRING;
       *argument_count += 1;
       break;
     case 'S':
-      static_buffer_->signature[index] = SignatureType::SIGNATURE_TYPE_STRING_REFERENCE;
+      static_buffer_->signature[signature_index] = SignatureType::SIGNATURE_TYPE_STRING_REFERENCE;
+      static_buffer_->string_capacity[signature_index] = StaticBuffer::kDefaultStringLength;
       *return_count += 1;
+
+      // The capacity of the string may optionally follow the 'S', for example 'S24'.
+      if (index + 1 < string.length() && isdigit((*string)[index + 1])) {
+        size_t capacity = 0;
+        while (index + 1 < string.length() && isdigit((*string)[index + 1]))
+          capacity = capacity * 10 + ((*string)[++index] - '0');
+
+        if (!capacity || capacity > kMaxBufferCapacity)
+          return false;
+
+        static_buffer_->string_capacity[signature_index] = capacity;
+      }
       break;
     default:
       // The argument type passed in the signature is unknown.
       return false;
     }
+
+    ++signature_index;
   }
 
   return true;
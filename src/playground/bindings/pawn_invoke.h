@@ -6,6 +6,8 @@
 #define PLAYGROUND_BINDINGS_PAWN_INVOKE_H_
 
 #include <memory>
+#include <string>
+#include <vector>
 
 #include <include/v8.h>
 
@@ -23,14 +25,21 @@ namespace bindings {
 //     any pawnInvoke(string name[, string signature[, ...]]);
 //
 // The function |name| must always be passed, and it must be a non-zero length string. It indicates
-// the name of the SA-MP native that should be invoked, for example "GetMaxPlayers".
+// the name of the SA-MP native that should be invoked, for example "GetMaxPlayers". Alternatively
+// the Id of the native may be passed, as obtained through pawnNativeId(name), which avoids having
+// to look up the native by its name for every invocation.
 //
 // The |signature| defines the signature of the native function. The syntax of the signature comes
 // down to the to the following:
 //
-//     signature       =  (argument_types)*
+//     signature       =  (return_type ':')? (argument_types)*
+//     return_type     =  [bfi]
 //     argument_types  =  [fFiIsS]
 //
+//         'b' - boolean return value
+//         'f' - float return value
+//         'i' - integer return value (default)
+//
 //         'f' - float
 //         'F' - float reference (will be returned)
 //         'i' - integer
@@ -40,7 +49,9 @@ namespace bindings {
 //
 // Validation of the arguments will be done in a strict matter. Arguments of types [fis] must be
 // present in the arguments following the |signature|. Note that it is not necessary to specify
-// string length when using the [S] string reference argument from JavaScript.
+// string length when using the [S] string reference argument from JavaScript. The capacity that
+// is advertised to the native may optionally follow the 'S', for example 'iS24'. It defaults to
+// 3072 characters. Strings and arrays passed to the native are not limited in length.
 //
 // Finally, in the current implementation there is a limitation that no non-reference arguments
 // may follow reference arguments. This could be optimized, but simplifies the initial version.
@@ -53,9 +64,11 @@ namespace bindings {
 //     native SetPlayerName(playerid, name[])           'is'
 //     native GetPlayerPos(playerid, &Float: x, ...)    'iFFF'
 //     native SetPlayerPos(playerid, Float: x, ...)     'ifff'
+//     native Float: VectorSize(Float: x, ...)          'f:fff'
+//     native bool: IsValidVehicle(vehicleid)           'b:i'
 //
-// TODO: Functions with non-integral return types need a way to indicate this in the signature,
-// for example functions returning a Float or a bool.
+// The return type only applies to the native's return value, which will be returned when there
+// are no reference arguments. Otherwise the reference arguments will be returned.
 class PawnInvoke {
  public:
   explicit PawnInvoke(plugin::PluginController* plugin_controller);
@@ -65,14 +78,46 @@ class PawnInvoke {
   // the class-level documentation about the inner workings of this method.
   v8::Local<v8::Value> Call(const v8::FunctionCallbackInfo<v8::Value>& arguments);
 
+  // Queues a call to the Pawn native indicated by |arguments|, which will be executed at the end of
+  // the server frame. This is the implementation of the pawnInvokeDeferred() function:
+  //     void pawnInvokeDeferred(string name, string signature[, ...]);
+  //
+  // Only the [fis] argument types are supported, as deferred calls cannot return values. The
+  // |signature| may be prefixed with an equals sign ('=') to indicate that the call supersedes an
+  // earlier '='-call to the same native on the same target, for example:
+  //     pawnInvokeDeferred('SetPlayerPos', '=ifff', playerid, x, y, z);
+  //
+  // The target is identified by the leading integer arguments, e.g. the playerid in this example.
+  void CallDeferred(const v8::FunctionCallbackInfo<v8::Value>& arguments);
+
+  // Calls a Pawn public function once for each set of arguments in |arguments|. This is the
+  // implementation of the callPublicBatch() function:
+  //     Int32Array callPublicBatch(string name, string format, array packedArgs);
+  //
+  // The |packedArgs| contain the arguments for each of the invocations one after another, so its
+  // length must be a multiple of the |format|'s length. Only the [fis] argument types are supported.
+  // The function will be looked up once, and its return values will be returned in order, e.g.:
+  //     callPublicBatch('OnPlayerLevelChange', 'ii', [ 0, 2, 5, 1 ]);
+  v8::Local<v8::Value> CallPublicBatch(const v8::FunctionCallbackInfo<v8::Value>& arguments);
+
+  // Returns the Id of the native named |function_name|, or -1 when it does not exist (yet).
+  int GetNativeId(const std::string& function_name);
+
  private:
   // Maximum number of arguments and return values supported in a Pawn call.
   static const size_t kMaxArgumentCount = 24;
 
+  // Maximum capacity that may be requested for a string reference argument, or an array.
+  static const size_t kMaxBufferCapacity = 65536;
+
+  // Maximum number of invocations that may be made in a single batch.
+  static const size_t kMaxBatchSize = 4096;
+
   struct StaticBuffer;
 
-  // Parses the |signature| and stores the resulting types in |static_buffer_|. The number of
-  // argument and return values will be stored in their respective out-arguments.
+  // Parses the |signature| and stores the resulting types, including the native's return type, in
+  // |static_buffer_|. The number of argument and return values will be stored in their respective
+  // out-arguments.
   bool ParseSignature(v8::Local<v8::Value> signature,
                       size_t* argument_count, size_t* return_count);
 
@@ -5,6 +5,7 @@
 #include "bindings/provided_natives.h"
 
 #include "base/logging.h"
+#include "bindings/exception_handler.h"
 #include "bindings/runtime_operations.h"
 #include "bindings/utilities.h"
 
@@ -30,151 +31,293 @@ ProvidedNatives* ProvidedNatives::GetInstance() {
 }
 
 void ProvidedNatives::SetNatives(const std::vector<std::string>& natives) {
-  for (const std::string& native : natives)
-    known_natives_.insert(native);
+  natives_.resize(natives.size());
+
+  for (size_t index = 0; index < natives.size(); ++index) {
+    natives_[index].name = natives[index];
+    native_indices_[natives[index]] = index;
+  }
 }
 
-bool ProvidedNatives::Register(const std::string& name, const std::string& signature, v8::Local<v8::Function> fn) {
-  if (known_natives_.find(name) == known_natives_.end())
+bool ProvidedNatives::Register(const std::string& name, const std::string& signature, v8::Local<v8::Function> fn,
+                               bool async) {
+  auto index_iter = native_indices_.find(name);
+  if (index_iter == native_indices_.end())
     return false;  // the native named |name| is not known.
 
-  StoredNative native;
-  native.param_count = 0;
-  native.retval_count = 0;
+  if (signature.size() > kMaxParameters)
+    return false;  // too many parameters in the signature.
+
+  std::vector<ParameterStep> inputs, outputs;
 
   for (size_t i = 0; i < signature.size(); ++i) {
+    const uint8_t index = static_cast<uint8_t>(i);
+
     switch (signature[i]) {
     case 'f':
+      inputs.push_back({ PARAMETER_READ_FLOAT, index });
+      break;
     case 'i':
+      inputs.push_back({ PARAMETER_READ_INTEGER, index });
+      break;
     case 's':
-      native.param_count++;
+      inputs.push_back({ PARAMETER_READ_STRING, index });
       break;
     case 'F':
+      outputs.push_back({ PARAMETER_WRITE_FLOAT, index });
+      break;
     case 'I':
+      outputs.push_back({ PARAMETER_WRITE_INTEGER, index });
+      break;
     case 'S':
-      native.retval_count++;
+      outputs.push_back({ PARAMETER_WRITE_STRING, index });
       break;
     default:
       return false;  // unrecognized character in the signature.
     }
   }
 
-  native.name = name;
+  if (async && outputs.size() > 0)
+    return false;  // asynchronous natives cannot return values.
+
+  StoredNative& native = natives_[index_iter->second];
   native.signature = signature;
+  native.inputs = std::move(inputs);
+  native.outputs = std::move(outputs);
   native.reference = v8::Persistent<v8::Function>(v8::Isolate::GetCurrent(), fn);
+  native.async = async;
+  native.registered = true;
+  native.generation++;
 
-  native_handlers_[name] = native;
   return true;
 }
 
-int32_t ProvidedNatives::Call(const std::string& name, plugin::NativeParameters& params) {
-  auto native_iter = native_handlers_.find(name);
-  if (native_iter == native_handlers_.end()) {
-    LOG(WARNING) << "No JavaScript listener has been defined for the " << name << " native.";
+int32_t ProvidedNatives::Call(size_t native_index, plugin::NativeParameters& params) {
+  if (native_index >= natives_.size() || !natives_[native_index].registered) {
+    LOG(WARNING) << "No JavaScript listener has been defined for the "
+                 << (native_index < natives_.size() ? natives_[native_index].name : "unknown")
+                 << " native.";
     return 0;
   }
 
+  const StoredNative& native = natives_[native_index];
+  if (params.count() < native.signature.size())
+    return 0;  // not enough parameters.
+
+  if (native.async) {
+    QueueAsyncCall(native_index, params);
+    return 1;
+  }
+
   v8::Isolate* isolate = v8::Isolate::GetCurrent();
   auto context = isolate->GetCurrentContext();
 
-  const StoredNative& native = native_iter->second;
-  if (params.count() < native.param_count)
-    return 0;  // not enough parameters.
-
   v8::HandleScope scope(isolate);
 
-  std::vector<v8::Local<v8::Value>> arguments(native.param_count);
+  v8::Local<v8::Value> arguments[kMaxParameters];
+  size_t argument_count = 0;
 
-  size_t param_index = 0;
-  for (size_t i = 0; i < native.signature.size(); ++i) {
-    switch (native.signature[i]) {
-    case 'f':
-      arguments[param_index++] = v8::Number::New(isolate, static_cast<double>(params.GetFloat(i)));
+  for (const ParameterStep& step : native.inputs) {
+    switch (step.operation) {
+    case PARAMETER_READ_FLOAT:
+      arguments[argument_count++] =
+          v8::Number::New(isolate, static_cast<double>(params.GetFloat(step.index)));
       break;
-    case 'i':
-      arguments[param_index++] = v8::Number::New(isolate, static_cast<double>(params.GetInteger(i)));
+    case PARAMETER_READ_INTEGER:
+      arguments[argument_count++] =
+          v8::Number::New(isolate, static_cast<double>(params.GetInteger(step.index)));
       break;
-    case 's':
-      arguments[param_index++] = v8String(params.GetString(i, &text_buffer_));
+    case PARAMETER_READ_STRING:
+      arguments[argument_count++] = v8String(params.GetString(step.index, &text_buffer_));
+      break;
+    default:
+      DCHECK(false) << "Unexpected operation for a provided native.";
       break;
     }
   }
 
-  CHECK(param_index == native.param_count);
+  if (native.reference.IsEmpty()) {
+    LOG(WARNING) << "[v8] Empty function found for native " << native.name;
+    return 0;
+  }
 
-  int return_value = 1;
-  {
-    if (native.reference.IsEmpty()) {
-      LOG(WARNING) << "[v8] Empty function found for native " << native.name;
-      return 0;
-    }
+  v8::Local<v8::Function> function = native.reference.Get(isolate);
+  if (function.IsEmpty()) {
+    LOG(WARNING) << "[v8] Unable to coerce the persistent funtion to a local for native " << native.name;
+    return 0;
+  }
 
-    v8::Local<v8::Function> function = native.reference.Get(isolate);
-    if (function.IsEmpty()) {
-      LOG(WARNING) << "[v8] Unable to coerce the persistent funtion to a local for native " << native.name;
-      return 0;
-    }
+  v8::Local<v8::Value> value = bindings::Call(isolate, function, arguments, argument_count);
+  if (value.IsEmpty())
+    value = v8::Number::New(isolate, 0 /* default value */);
 
-    v8::Local<v8::Value> value = bindings::Call(isolate, function, arguments.data(), arguments.size());
-    if (value.IsEmpty())
-      value = v8::Number::New(isolate, 0 /* default value */);
+  if (native.outputs.empty()) {
+    if (value->IsInt32())
+      return value->Int32Value(context).ToChecked();
 
-    if (native.retval_count == 0 && value->IsInt32()) {
-      return_value = value->Int32Value(context).ToChecked();
-    } else if (native.retval_count > 0) {
-      if (!value->IsArray())
-        return -1;  // reference values must be returned in an array
+    return 1;
+  }
 
-      v8::Local<v8::Array> arr = v8::Local<v8::Array>::Cast(value);
-      if (arr->Length() != native.retval_count)
-        return -1;  // a wrong amount of reference values has been returned
+  if (!value->IsArray())
+    return -1;  // reference values must be returned in an array
 
-      size_t retval_index = 0;
-      for (size_t i = 0; i < native.signature.size(); ++i) {
-        if (native.signature[i] != 'I' && native.signature[i] != 'F' && native.signature[i] != 'S')
-          continue;
+  v8::Local<v8::Array> arr = v8::Local<v8::Array>::Cast(value);
+  if (arr->Length() != native.outputs.size())
+    return -1;  // a wrong amount of reference values has been returned
 
-        v8::Local<v8::Value> retval = arr->Get(context, retval_index++).ToLocalChecked();
-        if (retval.IsEmpty()) {
-          LOG(WARNING) << "[v8] Unable to read return values of " << native.name << ": parameter "
-                       << i << " not set.";
+  uint32_t retval_index = 0;
+  for (const ParameterStep& step : native.outputs) {
+    v8::Local<v8::Value> retval;
+    if (!arr->Get(context, retval_index++).ToLocal(&retval)) {
+      LOG(WARNING) << "[v8] Unable to read return values of " << native.name << ": parameter "
+                   << static_cast<int>(step.index) << " not set.";
 
-          // Always resort to setting the default value to whatever Pawn expects.
-          retval = v8::Null(isolate);
-        }
+      // Always resort to setting the default value to whatever Pawn expects.
+      retval = v8::Null(isolate);
+    }
 
-        switch (native.signature[i]) {
-        case 'F':
-          if (retval->IsNumber())
-            params.SetFloat(i, static_cast<float>(retval->NumberValue(context).ToChecked()));
-          else
-            params.SetFloat(i, -1);
-          break;
-        case 'I':
-          if (retval->IsInt32())
-            params.SetInteger(i, retval->Int32Value(context).ToChecked());
-          else
-            params.SetInteger(i, -1);
-          break;
-        case 'S':
-          if (retval->IsString()) {
-            v8::String::Utf8Value text_value(isolate, retval);
-            if (text_value.length()) {
-              params.SetString(i, *text_value, text_value.length() + 1);
-              break;
-            }
-          }
-
-          params.SetString(i, "", 1);  // the empty string
+    switch (step.operation) {
+    case PARAMETER_WRITE_FLOAT:
+      if (retval->IsNumber())
+        params.SetFloat(step.index, static_cast<float>(retval->NumberValue(context).ToChecked()));
+      else
+        params.SetFloat(step.index, -1);
+      break;
+    case PARAMETER_WRITE_INTEGER:
+      if (retval->IsInt32())
+        params.SetInteger(step.index, retval->Int32Value(context).ToChecked());
+      else
+        params.SetInteger(step.index, -1);
+      break;
+    case PARAMETER_WRITE_STRING:
+      if (retval->IsString()) {
+        // Write the string's UTF-8 representation in to the reused |text_buffer_|, rather than
+        // having v8::String::Utf8Value allocate memory for it.
+        v8::Local<v8::String> string = v8::Local<v8::String>::Cast(retval);
+
+        const int length = string->Utf8Length(isolate);
+        if (length) {
+          text_buffer_.resize(length + 1);
+          string->WriteUtf8(isolate, &text_buffer_[0], length + 1);
+
+          params.SetString(step.index, text_buffer_.c_str(), length + 1);
           break;
         }
       }
 
-      CHECK(retval_index == native.retval_count);
+      params.SetString(step.index, "", 1);  // the empty string
+      break;
+    default:
+      DCHECK(false) << "Unexpected operation for a provided native.";
+      break;
+    }
+  }
+
+  return 1;
+}
+
+void ProvidedNatives::FlushAsyncCalls() {
+  if (!async_call_count_)
+    return;
+
+  // Move the queued calls aside, as executing the natives may cause new calls to be queued.
+  flushing_async_calls_.swap(async_calls_);
+
+  const size_t call_count = async_call_count_;
+  async_call_count_ = 0;
+
+  v8::Isolate* isolate = v8::Isolate::GetCurrent();
+  ScopedExceptionSource source("asynchronous native");
+
+  v8::Local<v8::Value> arguments[kMaxParameters];
+
+  for (size_t index = 0; index < call_count; ++index) {
+    const AsyncCall& call = flushing_async_calls_[index];
+    const StoredNative& native = natives_[call.native_index];
+    const plugin::Arguments& call_arguments = call.arguments;
+
+    if (call.generation != native.generation) {
+      ++stale_async_calls_;
+      continue;
+    }
+
+    v8::HandleScope scope(isolate);
+
+    if (native.reference.IsEmpty()) {
+      LOG(WARNING) << "[v8] Empty function found for native " << native.name;
+      continue;
+    }
+
+    size_t argument_count = 0;
+    for (const ParameterStep& step : native.inputs) {
+      switch (step.operation) {
+      case PARAMETER_READ_FLOAT:
+        arguments[argument_count++] =
+            v8::Number::New(isolate, static_cast<double>(call_arguments.GetFloat(step.index)));
+        break;
+      case PARAMETER_READ_INTEGER:
+        arguments[argument_count++] =
+            v8::Number::New(isolate, static_cast<double>(call_arguments.GetInteger(step.index)));
+        break;
+      case PARAMETER_READ_STRING:
+        arguments[argument_count++] = v8String(call_arguments.GetString(step.index));
+        break;
+      default:
+        DCHECK(false) << "Unexpected operation for a provided native.";
+        break;
+      }
     }
+
+    v8::Local<v8::Function> function = native.reference.Get(isolate);
+    bindings::Call(isolate, function, arguments, argument_count);
+  }
+
+  if (dropped_async_calls_) {
+    LOG(WARNING) << "Dropped " << dropped_async_calls_ << " calls to asynchronous natives, as the "
+                 << "queue was full.";
+    dropped_async_calls_ = 0;
+  }
+
+  if (stale_async_calls_) {
+    LOG(WARNING) << "Dropped " << stale_async_calls_ << " calls to asynchronous natives, as the "
+                 << "natives have been registered again since.";
+    stale_async_calls_ = 0;
   }
+}
+
+void ProvidedNatives::QueueAsyncCall(size_t native_index, plugin::NativeParameters& params) {
+  if (async_call_count_ >= kMaxAsyncCalls) {
+    ++dropped_async_calls_;
+    return;
+  }
+
+  if (async_call_count_ == async_calls_.size())
+    async_calls_.emplace_back();
 
-  return return_value;
+  const StoredNative& native = natives_[native_index];
+
+  AsyncCall& call = async_calls_[async_call_count_++];
+  call.native_index = native_index;
+  call.generation = native.generation;
+  call.arguments.Reset(native.signature.size());
+
+  // Asynchronous natives do not have reference parameters, so all parameters are inputs.
+  for (const ParameterStep& step : native.inputs) {
+    switch (step.operation) {
+    case PARAMETER_READ_FLOAT:
+      call.arguments.SetFloat(step.index, params.GetFloat(step.index));
+      break;
+    case PARAMETER_READ_INTEGER:
+      call.arguments.SetInteger(step.index, params.GetInteger(step.index));
+      break;
+    case PARAMETER_READ_STRING:
+      call.arguments.SetString(step.index, params.GetString(step.index, &text_buffer_));
+      break;
+    default:
+      DCHECK(false) << "Unexpected operation for a provided native.";
+      break;
+    }
+  }
 }
 
 }  // namespace bindings
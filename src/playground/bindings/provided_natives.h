@@ -8,18 +8,22 @@
 #include <stdint.h>
 #include <string>
 #include <unordered_map>
-#include <unordered_set>
 #include <vector>
 
 #include <include/v8.h>
 
 #include "base/macros.h"
+#include "plugin/arguments.h"
 #include "plugin/native_parameters.h"
 
 namespace bindings {
 
 // JavaScript can provide a number of native functions to Pawn, all of which will be routed through
 // this class. It will maintain references to the JavaScript functions implementing the natives.
+//
+// Natives that do not return values through reference parameters may be registered as being
+// asynchronous. Calls to such natives will have their parameters copied in to a queue, and return
+// 1 to Pawn immediately. The queued calls will be executed in order at the next server frame.
 class ProvidedNatives {
 public:
   ProvidedNatives();
@@ -28,38 +32,109 @@ public:
   // Gets the current instance of the ProvidedNatives class.
   static ProvidedNatives* GetInstance();
 
-  // Sets the natives identified by the `natives.txt` file that may be handled by this class.
+  // Maximum number of parameters that a provided native may accept.
+  static constexpr size_t kMaxParameters = 32;
+
+  // Sets the natives identified by the `natives.txt` file that may be handled by this class. The
+  // index of a native in |natives| will be used to identify it when it's being called.
   void SetNatives(const std::vector<std::string>& natives);
 
   // Returns whether the native |name| has been provided by the JavaScript code.
   bool IsProvided(const std::string& name) const {
-    return !!known_natives_.count(name);
+    return !!native_indices_.count(name);
   }
 
   // Registers the |fn| as handling the native called |name|. Returns whether it could be registered
-  // successfully- the Function value associated with |name| will be found automatically.
-  bool Register(const std::string& name, const std::string& signature, v8::Local<v8::Function> fn);
+  // successfully- the Function value associated with |name| will be found automatically. Natives
+  // can only be |async| when their |signature| does not contain reference parameters.
+  bool Register(const std::string& name, const std::string& signature, v8::Local<v8::Function> fn,
+                bool async = false);
+
+  // Calls the |fn| in JavaScript given the |parameters|, or queues the call for asynchronous natives.
+  // The |native_index| is the index of the native in the list given to SetNatives().
+  int32_t Call(size_t native_index, plugin::NativeParameters& params);
+
+  // Executes the queued calls to asynchronous natives. Calls that are queued while doing so will be
+  // executed by the next flush. Must be called with a handle scope and context on the stack.
+  void FlushAsyncCalls();
 
-  // Calls the |fn| in JavaScript given the |parameters|.
-  int32_t Call(const std::string& name, plugin::NativeParameters& params);
+  // Returns the number of calls to asynchronous natives that are waiting to be executed.
+  size_t async_call_count() const { return async_call_count_; }
 
 private:
+  // Maximum number of calls to asynchronous natives that may be queued. Further calls are dropped.
+  static constexpr size_t kMaxAsyncCalls = 65536;
+
   using v8PersistentFunctionReference = v8::Persistent<v8::Function, v8::CopyablePersistentTraits<v8::Function>>;
 
   // Buffer to be used for converting Pawn string to JavaScript strings.
   std::string text_buffer_;
 
-  // Set of the natives which are known to this class.
-  std::unordered_set<std::string> known_natives_;
-  
+  // Operations through which the parameters of a native will be converted. The signature of a
+  // native is decoded in to a list of operations when it gets registered.
+  enum ParameterOperation : uint8_t {
+    PARAMETER_READ_FLOAT,     // 'f'
+    PARAMETER_READ_INTEGER,   // 'i'
+    PARAMETER_READ_STRING,    // 's'
+    PARAMETER_WRITE_FLOAT,    // 'F'
+    PARAMETER_WRITE_INTEGER,  // 'I'
+    PARAMETER_WRITE_STRING,   // 'S'
+  };
+
+  struct ParameterStep {
+    ParameterOperation operation;
+
+    // Index of the parameter in the native's signature.
+    uint8_t index;
+  };
+
   struct StoredNative {
-    size_t param_count, retval_count;
     std::string name, signature;
+
+    // Steps for reading the parameters passed by Pawn, and for writing reference parameters.
+    std::vector<ParameterStep> inputs;
+    std::vector<ParameterStep> outputs;
+
     v8PersistentFunctionReference reference;
+    bool async = false;
+    bool registered = false;
+
+    // Incremented each time the native gets registered, invalidating calls queued before.
+    uint32_t generation = 0;
   };
 
-  // Mapping of function name to the JavaScript function handling the native.
-  std::unordered_map<std::string, StoredNative> native_handlers_;
+  // A queued call to an asynchronous native. Instances are retained to reuse their storage.
+  struct AsyncCall {
+    size_t native_index;
+    plugin::Arguments arguments;
+
+    // Generation of the native at the time of the call. The |arguments| were decoded with the
+    // parameter steps of that generation, so they can't be passed to later registrations.
+    uint32_t generation;
+  };
+
+  // Copies the |params| for a call to the asynchronous native at |native_index| in to the queue.
+  void QueueAsyncCall(size_t native_index, plugin::NativeParameters& params);
+
+  // The natives known to this class, indexed by the order in which they were given to SetNatives(),
+  // together with the JavaScript function handling them when registered.
+  std::vector<StoredNative> natives_;
+
+  // Mapping of function name to the index of the native in |natives_|.
+  std::unordered_map<std::string, size_t> native_indices_;
+
+  // Queue of calls to asynchronous natives, and the calls that are being flushed.
+  std::vector<AsyncCall> async_calls_;
+  size_t async_call_count_ = 0;
+
+  std::vector<AsyncCall> flushing_async_calls_;
+
+  // Number of calls to asynchronous natives that have been dropped because the queue was full.
+  size_t dropped_async_calls_ = 0;
+
+  // Number of calls to asynchronous natives that have been dropped because the native has been
+  // registered again since they were queued.
+  size_t stale_async_calls_ = 0;
 
   DISALLOW_COPY_AND_ASSIGN(ProvidedNatives);
 };
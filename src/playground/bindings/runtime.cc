@@ -46,6 +46,9 @@ const char kRuntimeFlags[] =
     "--harmony_intl_dateformat_day_period "
     "--harmony_intl_segmenter";
 
+// Directory, relative to the server, in which code cache entries for the modules will be stored.
+const char kCodeCacheDirectory[] = "data/server/code_cache";
+
 // Returns whether |character| represents a line break.
 bool IsLineBreak(char character) {
   return character == '\n' || character == '\r';
@@ -170,6 +173,7 @@ Runtime::Runtime(Delegate* runtime_delegate,
       plugin_controller, main_thread_io_context_, background_io_context_);
 
   source_directory_ = base::FilePath::CurrentDirectory().Append("javascript");
+  code_cache_directory_ = base::FilePath::CurrentDirectory().Append(kCodeCacheDirectory);
 }
 
 Runtime::~Runtime() {
@@ -205,7 +209,8 @@ void Runtime::Initialize() {
 
   context_.Reset(isolate_, context);
 
-  modulator_.reset(new RuntimeModulator(isolate_, source_directory_));
+  modulator_.reset(new RuntimeModulator(isolate_, source_directory_, code_cache_directory_,
+                                        background_io_context_));
   modulator_->LoadModule(context, /* referrer= */ base::FilePath(), "main.js");
 }
 
@@ -218,6 +223,10 @@ void Runtime::SpinUntilReady() {
 
 void Runtime::SetReady() {
   is_ready_ = true;
+
+  // The modules have run successfully, so their code can be cached for the next run.
+  if (modulator_)
+    modulator_->WriteCodeCache();
 }
 
 void Runtime::GetAndResetFrameCounter(double* duration, double* average_fps) {
@@ -240,6 +249,15 @@ void Runtime::OnFrame() {
   for (FrameObserver* observer : frame_observers_)
     observer->OnFrame();
 
+  // Execute the calls to asynchronous natives that Pawn made since the previous frame.
+  ProvidedNatives* provided_natives = global_scope_->GetProvidedNatives();
+  if (provided_natives->async_call_count()) {
+    v8::HandleScope handle_scope(isolate_);
+    v8::Context::Scope context_scope(context());
+
+    provided_natives->FlushAsyncCalls();
+  }
+
   timer_queue_->Run(current_time);
 
   isolate_->RunMicrotasks();
@@ -130,6 +130,7 @@ class Runtime {
   Runtime(Delegate* runtime_delegate, plugin::PluginController* plugin_controller);
 
   base::FilePath source_directory_;
+  base::FilePath code_cache_directory_;
   Delegate* runtime_delegate_;
 
   // Set of attached frame observers.
@@ -8,9 +8,11 @@
 #include <boost/filesystem.hpp>
 #include <fstream>
 #include <sstream>
+#include <vector>
 
 #include "base/logging.h"
 #include "bindings/exception_handler.h"
+#include "bindings/module_code_cache.h"
 #include "bindings/runtime.h"
 #include "bindings/utilities.h"
 
@@ -63,8 +65,12 @@ v8::MaybeLocal<v8::Promise> RuntimeModulator::ImportModuleDynamicallyCallback(
     context, base::FilePath(referrer_string), toString(specifier));
 }
 
-RuntimeModulator::RuntimeModulator(v8::Isolate* isolate, const base::FilePath& root)
-  : isolate_(isolate), root_(root) {}
+RuntimeModulator::RuntimeModulator(v8::Isolate* isolate, const base::FilePath& root,
+                                   const base::FilePath& code_cache_directory,
+                                   boost::asio::io_context& background_io_context)
+  : isolate_(isolate), root_(root),
+    code_cache_(std::make_shared<ModuleCodeCache>(code_cache_directory, v8::V8::GetVersion())),
+    background_io_context_(background_io_context) {}
 
 RuntimeModulator::~RuntimeModulator() = default;
 
@@ -122,6 +128,39 @@ void RuntimeModulator::ClearCache(const std::string& relative_prefix) {
     modules_.erase(path);
 }
 
+void RuntimeModulator::WriteCodeCache() {
+  if (uncached_modules_.empty())
+    return;
+
+  v8::HandleScope handle_scope(isolate_);
+
+  for (const auto& pair : uncached_modules_) {
+    v8::Local<v8::Module> module;
+    if (!GetModule(pair.first).ToLocal(&module))
+      continue;  // the module has been removed from the cache since
+
+    // Only modules that ran successfully will have their code cached.
+    if (module->GetStatus() != v8::Module::kEvaluated)
+      continue;
+
+    std::unique_ptr<v8::ScriptCompiler::CachedData> cached_data(
+        v8::ScriptCompiler::CreateCodeCache(module->GetUnboundModuleScript()));
+    if (!cached_data || cached_data->length <= 0)
+      continue;
+
+    // Writing the entry involves disk I/O, which shouldn't block the server's frame.
+    std::vector<uint8_t> data(cached_data->data, cached_data->data + cached_data->length);
+    background_io_context_.post(
+        [code_cache = code_cache_, path = pair.first, source_hash = pair.second,
+         data = std::move(data)]() {
+      if (!code_cache->Store(path, source_hash, data.data(), data.size()))
+        LOG(WARNING) << "Unable to write the code cache for " << path.value();
+    });
+  }
+
+  uncached_modules_.clear();
+}
+
 void RuntimeModulator::ResolveOrCreateModule(
   v8::Local<v8::Context> context,
   v8::Local<v8::Promise::Resolver> resolver,
@@ -163,6 +202,10 @@ void RuntimeModulator::ResolveOrCreateModule(
 
   v8::Local<v8::Value> module_ns = module->GetModuleNamespace();
   resolver->Resolve(context, module_ns).ToChecked();
+
+  // Modules loaded after the runtime became ready would otherwise never have their code cached.
+  if (Runtime::FromIsolate(isolate_)->IsReady())
+    WriteCodeCache();
 }
 
 v8::MaybeLocal<v8::Module> RuntimeModulator::GetModule(const base::FilePath& path) {
@@ -176,7 +219,7 @@ v8::MaybeLocal<v8::Module> RuntimeModulator::GetModule(const base::FilePath& pat
 v8::MaybeLocal<v8::Module> RuntimeModulator::CreateModule(
     v8::Local<v8::Context> context,
     const base::FilePath& path) {
-  v8::Local<v8::String> code;
+  std::string code;
   if (!ReadFile(path, &code)) {
     ThrowException("Unable to open the module for reading: " + path.value());
     return v8::MaybeLocal<v8::Module>();
@@ -194,12 +237,45 @@ v8::MaybeLocal<v8::Module> RuntimeModulator::CreateModule(
       v8::Local<v8::Boolean>() /* is_wasm */,
       v8::True(isolate) /* is_module */);
 
-  v8::ScriptCompiler::Source source(code, origin);
+  const uint64_t source_hash = ModuleCodeCache::ComputeSourceHash(code);
+
+  // Consume the code that was cached for this module by a previous run when available, which saves
+  // having to parse and compile it. The |source| takes ownership of the |cached_data|, but not of
+  // the |cached_code| buffer, which must outlive compilation.
+  std::vector<uint8_t> cached_code;
+  v8::ScriptCompiler::CachedData* cached_data = nullptr;
+
+  if (code_cache_->Load(path, source_hash, &cached_code)) {
+    cached_data = new v8::ScriptCompiler::CachedData(
+        cached_code.data(), static_cast<int>(cached_code.size()),
+        v8::ScriptCompiler::CachedData::BufferNotOwned);
+  }
+
+  v8::ScriptCompiler::Source source(v8String(code), origin, cached_data);
+  v8::ScriptCompiler::CompileOptions options =
+      cached_data ? v8::ScriptCompiler::kConsumeCodeCache : v8::ScriptCompiler::kNoCompileOptions;
 
   v8::Local<v8::Module> module;
-  if (!v8::ScriptCompiler::CompileModule(isolate, &source).ToLocal(&module))
+  if (!v8::ScriptCompiler::CompileModule(isolate, &source, options).ToLocal(&module))
     return v8::MaybeLocal<v8::Module>();
 
+  // v8 rejects cached code that was created with different flags, in which case the module has been
+  // compiled from source. Its entry is removed, and will be rewritten by WriteCodeCache() once the
+  // module has been evaluated successfully.
+  if (cached_data && !source.GetCachedData()->rejected) {
+    ++code_cache_hits_;
+  } else {
+    if (cached_data) {
+      background_io_context_.post([code_cache = code_cache_, path]() {
+        code_cache->Remove(path);
+      });
+
+      ++code_cache_rejects_;
+    }
+
+    uncached_modules_[path] = source_hash;
+  }
+
   DCHECK(!modules_.count(path));
   modules_.emplace(path, v8::Global<v8::Module>(isolate, module));
 
@@ -262,8 +338,7 @@ bool RuntimeModulator::ResolveModulePath(
   return false;
 }
 
-bool RuntimeModulator::ReadFile(const base::FilePath& path,
-                                v8::Local<v8::String>* contents) {
+bool RuntimeModulator::ReadFile(const base::FilePath& path, std::string* contents) {
   std::ifstream handle(path.value().c_str());
   if (!handle.is_open() || handle.fail())
     return false;
@@ -273,7 +348,7 @@ bool RuntimeModulator::ReadFile(const base::FilePath& path,
             std::istreambuf_iterator<char>(),
             std::ostreambuf_iterator<char>(source_stream));
 
-  *contents = v8String(source_stream.str());
+  *contents = source_stream.str();
   return true;
 }
 
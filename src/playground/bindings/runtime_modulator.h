@@ -5,7 +5,10 @@
 #ifndef PLAYGROUND_BINDINGS_RUNTIME_MODULATOR_H_
 #define PLAYGROUND_BINDINGS_RUNTIME_MODULATOR_H_
 
+#include <stdint.h>
+#include <boost/asio/io_context.hpp>
 #include <map>
+#include <memory>
 #include <string>
 
 #include <include/v8.h>
@@ -15,6 +18,8 @@
 
 namespace bindings {
 
+class ModuleCodeCache;
+
 // Implements the module loading semantics that power usage of ES Modules.
 // https://developer.mozilla.org/en-US/docs/Web/JavaScript/Reference/Statements/import
 class RuntimeModulator {
@@ -27,7 +32,12 @@ class RuntimeModulator {
       v8::Local<v8::ScriptOrModule> referrer,
       v8::Local<v8::String> specifier);
 
-  RuntimeModulator(v8::Isolate* isolate, const base::FilePath& root);
+  // Modules will be resolved against the |root|. Code cache entries for the modules will be stored
+  // in the |code_cache_directory|, and used to avoid compiling them again on subsequent runs. The
+  // entries are written to disk on the |background_io_context|.
+  RuntimeModulator(v8::Isolate* isolate, const base::FilePath& root,
+                   const base::FilePath& code_cache_directory,
+                   boost::asio::io_context& background_io_context);
   ~RuntimeModulator();
 
   // Loads the module identified by the |specifier| as the top-level module.
@@ -43,6 +53,15 @@ class RuntimeModulator {
   // Clears the cached modules whose path matches |prefix|.
   void ClearCache(const std::string& prefix);
 
+  // Writes code cache entries for the evaluated modules that had to be compiled from source. Should
+  // be called once the modules ran successfully, so that lazily compiled functions are included.
+  // The code is serialized synchronously, whereas the entries are written in the background.
+  void WriteCodeCache();
+
+  // Returns the number of modules whose code cache entry was used, or rejected by v8.
+  size_t code_cache_hits() const { return code_cache_hits_; }
+  size_t code_cache_rejects() const { return code_cache_rejects_; }
+
  private:
   // Aims to resolve the |resolver| with the module namespace object for a module
   // identified by |specifier|. If such a module is already loaded it will be
@@ -67,8 +86,7 @@ class RuntimeModulator {
 
   // Reads the file identified by |path| and writes the result to |contents|. Returns
   // whether the file could be read correctly. Failures must be handled.
-  bool ReadFile(const base::FilePath& path,
-                v8::Local<v8::String>* contents);
+  bool ReadFile(const base::FilePath& path, std::string* contents);
 
   v8::Isolate* isolate_;
   base::FilePath root_;
@@ -76,6 +94,18 @@ class RuntimeModulator {
   // Map of paths to loaded v8::Module instances.
   std::map<base::FilePath, v8::Global<v8::Module>> modules_;
 
+  // Persistent cache of the code v8 produced for the modules. Shared with the tasks that write
+  // its entries on the background thread, which may outlive this instance.
+  std::shared_ptr<ModuleCodeCache> code_cache_;
+  boost::asio::io_context& background_io_context_;
+
+  // Map of paths to the source hashes of modules that were compiled without using the code cache,
+  // for which entries will be written by WriteCodeCache().
+  std::map<base::FilePath, uint64_t> uncached_modules_;
+
+  size_t code_cache_hits_ = 0;
+  size_t code_cache_rejects_ = 0;
+
   DISALLOW_COPY_AND_ASSIGN(RuntimeModulator);
 };
 
@@ -10,6 +10,7 @@
 #include "base/time.h"
 #include "bindings/event.h"
 #include "bindings/global_scope.h"
+#include "bindings/modules/streamer/streamer_host.h"
 #include "bindings/runtime.h"
 #include "bindings/runtime_modulator.h"
 #include "bindings/utilities.h"
@@ -30,38 +31,65 @@ void PlaygroundController::OnCallbacksAvailable(const std::vector<plugin::Callba
 
   // Create event interfaces for each of the |callbacks| and install them on the global scope. This
   // will make sure that the properties of the SA-MP events can be inspected by the script.
-  for (const auto& callback : callbacks)
+  for (const auto& callback : callbacks) {
     global->RegisterEvent(callback.name, bindings::Event::Create(callback));
+    if (callback.deferred)
+      global->deferred_events().RegisterCallback(callback);
+
+    if (callback.name == "OnPlayerDisconnect")
+      on_player_disconnect_id_ = callback.id;
+  }
+
+  runtime_->GetStreamerHost()->RegisterCallbacks(callbacks);
+}
+
+bool PlaygroundController::OnCallbackIntercepted(const plugin::Callback& callback,
+                                                 const plugin::Arguments& arguments) {
+  // The streamer maintains the set of tracked players based on a number of callbacks.
+  runtime_->GetStreamerHost()->OnCallbackIntercepted(callback, arguments);
+
+  // Pending coalesced invocations for a player must not be forwarded after they disconnected.
+  if (callback.id == on_player_disconnect_id_)
+    callback_coalescer_.DiscardPlayer(arguments.GetInteger(0));
+
+  // Coalesced callbacks will be forwarded once their window has elapsed, from OnServerFrame().
+  if (callback.coalesce_index >= 0) {
+    callback_coalescer_.Add(callback, arguments, base::monotonicallyIncreasingTime());
+    return false;
+  }
+
+  return DispatchCallback(callback, arguments);
 }
 
-bool PlaygroundController::OnCallbackIntercepted(const std::string& callback,
-                                                 const plugin::Arguments& arguments,
-                                                 bool deferred) {
+bool PlaygroundController::DispatchCallback(const plugin::Callback& callback,
+                                            const plugin::Arguments& arguments) {
   bindings::GlobalScope* global = runtime_->GetGlobalScope();
 
-  // Fast-path where we store a copy of the |arguments| for dispatch later, which we consider to
-  // be deferred events. These are faster, can be scheduled, but cannot be responded to.
-  if (deferred) {
-    global->StoreDeferredEvent(callback, arguments.Copy());
+  // Fast-path where we store the |arguments| for dispatch later, which we consider to be deferred
+  // events. These are faster, can be scheduled, but cannot be responded to.
+  if (callback.deferred) {
+    global->StoreDeferredEvent(callback, arguments);
     return false;
   }
 
-  // Convert the |callback| name to the associated idiomatic JavaScript event type.
-  const std::string& type = bindings::Event::ToEventType(callback);
+  bindings::Event* event = global->GetEvent(callback);
+  DCHECK(event);
 
-  performance::ScopedTrace trace(performance::INTERCEPTED_CALLBACK_TOTAL, type);
+  performance::ScopedTrace trace(performance::INTERCEPTED_CALLBACK_TOTAL, event->type());
 
-  // Bail out immediately if there are no listeners for this callback.
-  if (!global->HasEventListeners(type))
+  // Bail out immediately if there are no listeners interested in this callback.
+  if (!global->HasEventListeners(event->type_id(), arguments))
     return false;
 
   v8::HandleScope handle_scope(runtime_->isolate());
   v8::Context::Scope context_scope(runtime_->context());
 
-  bindings::Event* event = global->GetEvent(callback);
-  DCHECK(event);
+  v8::Local<v8::Object> instance = event->NewInstance(arguments);
+  const bool result = global->DispatchEvent(event->type_id(), instance, &arguments);
 
-  return global->DispatchEvent(type, event->NewInstance(arguments));
+  // The |arguments| will be invalidated after this call, so detach them from the event.
+  event->Detach(instance);
+  return result;
 }
 
 // TODO: Clean up everything after here.
@@ -72,9 +100,20 @@ void PlaygroundController::OnGamemodeLoaded() {
 }
 
 void PlaygroundController::OnServerFrame() {
+  callback_coalescer_.Flush(base::monotonicallyIncreasingTime(),
+                            [this](const plugin::Callback& callback,
+                                   const plugin::Arguments& arguments) {
+    DispatchCallback(callback, arguments);
+  });
+
   runtime_->OnFrame();
 }
 
+void PlaygroundController::OnSharedBufferRemoved(const std::string& name) {
+  v8::HandleScope handle_scope(runtime_->isolate());
+  runtime_->GetGlobalScope()->DetachSharedBuffer(name);
+}
+
 void PlaygroundController::OnScriptOutput(const std::string& message) {
   if (!message.length())
     return;
@@ -7,6 +7,7 @@
 
 #include <memory>
 
+#include "plugin/callback_coalescer.h"
 #include "plugin/plugin_delegate.h"
 #include "bindings/runtime.h"
 
@@ -30,11 +31,11 @@ class PlaygroundController : public plugin::PluginDelegate,
 
   // plugin::PluginDelete implementation.
   void OnCallbacksAvailable(const std::vector<plugin::Callback>& callbacks) override;
-  bool OnCallbackIntercepted(const std::string& callback,
-                             const plugin::Arguments& arguments,
-                             bool deferred) override;
+  bool OnCallbackIntercepted(const plugin::Callback& callback,
+                             const plugin::Arguments& arguments) override;
   void OnGamemodeLoaded() override;
   void OnServerFrame() override;
+  void OnSharedBufferRemoved(const std::string& name) override;
 
   // bindings::Runtime::Delegate implementation.
   void OnScriptOutput(const std::string& message) override;
@@ -42,11 +43,23 @@ class PlaygroundController : public plugin::PluginDelegate,
   void OnScriptTestsDone(unsigned int total_tests, unsigned int failed_tests) override;
 
  private:
+  // Dispatches the |callback| with the given |arguments| to JavaScript, or stores it when it has
+  // been deferred. Returns whether the default action of the callback has been prevented.
+  bool DispatchCallback(const plugin::Callback& callback, const plugin::Arguments& arguments);
+
   // Weak, owns us. Allows communication with the SA-MP server and Pawn runtime.
   plugin::PluginController* plugin_controller_;
 
   // The v8 runtime that will be responsible for the JavaScript-based gamemode.
   std::shared_ptr<bindings::Runtime> runtime_;
+
+  // Coalesces invocations of callbacks annotated with Coalesce, forwarded at the next frame.
+  plugin::CallbackCoalescer callback_coalescer_;
+
+  // Id of the OnPlayerDisconnect callback, as assigned by the parser.
+  static constexpr size_t kInvalidCallbackId = static_cast<size_t>(-1);
+
+  size_t on_player_disconnect_id_ = kInvalidCallbackId;
 };
 
 }  // namespace playground
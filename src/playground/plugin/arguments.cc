@@ -6,6 +6,7 @@
 
 #include <sstream>
 
+#include "base/logging.h"
 #include "base/memory.h"
 #include "plugin/callback.h"
 
@@ -29,8 +30,10 @@ Arguments::Arguments()
 Arguments::Arguments(Arguments&& other) {
   instance_id_ = other.instance_id_;
   values_ = std::move(other.values_);
+  size_ = other.size_;
 
   other.instance_id_ = -1;
+  other.size_ = 0;
 }
 
 Arguments::~Arguments() {
@@ -41,63 +44,109 @@ Arguments::~Arguments() {
 void Arguments::operator=(Arguments&& other) noexcept {
   instance_id_ = other.instance_id_;
   values_ = std::move(other.values_);
+  size_ = other.size_;
 
   other.instance_id_ = -1;
+  other.size_ = 0;
 }
 
 Arguments Arguments::Copy() const {
   Arguments copy;
-  copy.values_ = values_;
+  copy.CopyFrom(*this);
 
   return copy;
 }
 
-void Arguments::AddInteger(const std::string& name, int value) {
-  values_[name] = std::make_any<int32_t>(value);
+void Arguments::CopyFrom(const Arguments& other) {
+  if (&other == this)
+    return;
+
+  Reset(other.size_);
+
+  // Only copy the active members of the values, rather than the retained storage of others.
+  for (size_t index = 0; index < size_; ++index) {
+    const Value& value = other.values_[index];
+    Value& copied_value = values_[index];
+
+    copied_value.type = value.type;
+    switch (value.type) {
+    case VALUE_TYPE_EMPTY:
+      break;
+    case VALUE_TYPE_INTEGER:
+      copied_value.integer = value.integer;
+      break;
+    case VALUE_TYPE_FLOAT:
+      copied_value.decimal = value.decimal;
+      break;
+    case VALUE_TYPE_STRING:
+      copied_value.string = value.string;
+      break;
+    case VALUE_TYPE_ARRAY:
+      copied_value.array = value.array;
+      break;
+    }
+  }
 }
 
-void Arguments::AddFloat(const std::string& name, float value) {
-  values_[name] = std::make_any<float>(value);
+void Arguments::Reset(size_t count) {
+  if (values_.size() < count)
+    values_.resize(count);
+
+  for (size_t index = 0; index < count; ++index)
+    values_[index].type = VALUE_TYPE_EMPTY;
+
+  size_ = count;
 }
 
-void Arguments::AddString(const std::string& name, const std::string& value) {
-  values_[name] = std::make_any<std::string>(value);
+void Arguments::SetInteger(size_t index, int value) {
+  DCHECK(index < size_);
+  values_[index].type = VALUE_TYPE_INTEGER;
+  values_[index].integer = value;
 }
 
-void Arguments::AddArray(const std::string& name, const Arguments::ArrayType& value) {
-  values_[name] = std::make_any<ArrayType>(value);
+void Arguments::SetFloat(size_t index, float value) {
+  DCHECK(index < size_);
+  values_[index].type = VALUE_TYPE_FLOAT;
+  values_[index].decimal = value;
 }
 
-int Arguments::GetInteger(const std::string& name) const {
-  auto value_iter = values_.find(name);
-  if (value_iter == values_.end() || value_iter->second.type() != typeid(int32_t))
-    return -1;
+void Arguments::SetString(size_t index, const std::string& value) {
+  DCHECK(index < size_);
+  values_[index].type = VALUE_TYPE_STRING;
+  values_[index].string.assign(value);
+}
 
-  return std::any_cast<int32_t>(value_iter->second);
+void Arguments::SetArray(size_t index, const Arguments::ArrayType& value) {
+  DCHECK(index < size_);
+  values_[index].type = VALUE_TYPE_ARRAY;
+  values_[index].array.assign(value.begin(), value.end());
 }
 
-float Arguments::GetFloat(const std::string& name) const {
-  auto value_iter = values_.find(name);
-  if (value_iter == values_.end() || value_iter->second.type() != typeid(float))
-    return -1.0;
+int Arguments::GetInteger(size_t index) const {
+  const Value* value = GetValue(index, VALUE_TYPE_INTEGER);
+  return value ? value->integer : -1;
+}
 
-  return std::any_cast<float>(value_iter->second);
+float Arguments::GetFloat(size_t index) const {
+  const Value* value = GetValue(index, VALUE_TYPE_FLOAT);
+  return value ? value->decimal : -1.0f;
 }
 
-const std::string& Arguments::GetString(const std::string& name) const {
-  auto value_iter = values_.find(name);
-  if (value_iter == values_.end() || value_iter->second.type() != typeid(std::string))
-    return g_empty_string;
+const std::string& Arguments::GetString(size_t index) const {
+  const Value* value = GetValue(index, VALUE_TYPE_STRING);
+  return value ? value->string : g_empty_string;
+}
 
-  return std::any_cast<const std::string&>(value_iter->second);
+const Arguments::ArrayType& Arguments::GetArray(size_t index) const {
+  const Value* value = GetValue(index, VALUE_TYPE_ARRAY);
+  return value ? value->array : g_empty_array;
 }
 
-const Arguments::ArrayType& Arguments::GetArray(const std::string& name) const {
-  auto value_iter = values_.find(name);
-  if (value_iter == values_.end() || value_iter->second.type() != typeid(ArrayType))
-    return g_empty_array;
+const Arguments::Value* Arguments::GetValue(size_t index, ValueType type) const {
+  if (index >= size_ || values_[index].type != type)
+    return nullptr;
 
-  return std::any_cast<const ArrayType&>(value_iter->second);
+  return &values_[index];
 }
 
 std::string GetCallbackRepresentation(const Callback& callback, const Arguments& arguments) {
@@ -110,13 +159,16 @@ std::string GetCallbackRepresentation(const Callback& callback, const Arguments&
   for (const auto& argument : callback.arguments) {
     switch (argument.second) {
     case ARGUMENT_TYPE_INT:
-      representation << arguments.GetInteger(argument.first);
+      representation << arguments.GetInteger(index);
       break;
     case ARGUMENT_TYPE_FLOAT:
-      representation << arguments.GetFloat(argument.first);
+      representation << arguments.GetFloat(index);
       break;
     case ARGUMENT_TYPE_STRING:
-      representation << "\"" << arguments.GetString(argument.first) << "\"";
+      representation << "\"" << arguments.GetString(index) << "\"";
+      break;
+    case ARGUMENT_TYPE_ARRAY:
+      representation << "[" << arguments.GetArray(index).size() << " cells]";
       break;
     }
 
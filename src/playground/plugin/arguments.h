@@ -5,10 +5,8 @@
 #ifndef PLAYGROUND_PLUGIN_ARGUMENTS_H_
 #define PLAYGROUND_PLUGIN_ARGUMENTS_H_
 
-#include <any>
 #include <stdint.h>
 #include <string>
-#include <unordered_map>
 #include <vector>
 
 #include "base/macros.h"
@@ -18,7 +16,12 @@ namespace plugin {
 struct Callback;
 
 // The Arguments class represents the arguments passed to a Pawn callback, which are to be forwarded
-// to the v8 runtime (or potentially other consumers).
+// to the v8 runtime (or potentially other consumers). Values are stored by their position in the
+// Callback's signature, so names have to be resolved through the Callback.
+//
+// Instances are designed to be reused across invocations: Reset() retains the storage of previous
+// values, including the capacity of strings and arrays, so that no heap allocations are necessary
+// once the instance has seen a callback of the same shape.
 class Arguments {
   using ArrayType = std::vector<uint32_t>;
 
@@ -33,22 +36,58 @@ class Arguments {
 
   Arguments Copy() const;
 
-  void AddInteger(const std::string& name, int value);
-  void AddFloat(const std::string& name, float value);
-  void AddString(const std::string& name, const std::string& value);
-  void AddArray(const std::string& name, const ArrayType& value);
+  // Replaces the values of this instance with copies of those in |other|, reusing the storage.
+  void CopyFrom(const Arguments& other);
 
-  int GetInteger(const std::string& name) const;
-  float GetFloat(const std::string& name) const;
-  const std::string& GetString(const std::string& name) const;
-  const ArrayType& GetArray(const std::string& name) const;
+  // Resets the instance to hold |count| values, each of which will be empty until it's set.
+  void Reset(size_t count);
 
-  size_t size() const { return values_.size(); }
-  void clear() { values_.clear(); }
+  void SetInteger(size_t index, int value);
+  void SetFloat(size_t index, float value);
+  void SetString(size_t index, const std::string& value);
+  void SetArray(size_t index, const ArrayType& value);
+
+  // Getters for the value at |index|. A default value will be returned when the value at |index|
+  // has not been set, or was set with a different type.
+  int GetInteger(size_t index) const;
+  float GetFloat(size_t index) const;
+  const std::string& GetString(size_t index) const;
+  const ArrayType& GetArray(size_t index) const;
+
+  size_t size() const { return size_; }
+  void clear() { size_ = 0; }
 
  private:
+  enum ValueType {
+    VALUE_TYPE_EMPTY,
+    VALUE_TYPE_INTEGER,
+    VALUE_TYPE_FLOAT,
+    VALUE_TYPE_STRING,
+    VALUE_TYPE_ARRAY
+  };
+
+  struct Value {
+    ValueType type = VALUE_TYPE_EMPTY;
+    union {
+      int32_t integer;
+      float decimal;
+    };
+
+    // Only valid when |type| is VALUE_TYPE_STRING or VALUE_TYPE_ARRAY respectively. These are not
+    // cleared when the value changes in order to retain their capacity.
+    std::string string;
+    ArrayType array;
+  };
+
+  // Returns the Value at |index| with the given |type|, or a nullptr when there is no such value.
+  const Value* GetValue(size_t index, ValueType type) const;
+
   int64_t instance_id_;
-  std::unordered_map<std::string, std::any> values_;
+
+  // Storage for the values. May be larger than |size_|, in which case the trailing values are
+  // retained for subsequent invocations.
+  std::vector<Value> values_;
+  size_t size_ = 0;
 };
 
 // Returns a textual callback representation visualizing the call that is being made in Pawn. This
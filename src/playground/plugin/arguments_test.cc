@@ -0,0 +1,55 @@
+// Copyright 2020 Las Venturas Playground. All rights reserved.
+// Use of this source code is governed by the MIT license, a copy of which can
+// be found in the LICENSE file.
+
+#include "plugin/arguments.h"
+
+#include "gtest/gtest.h"
+
+namespace plugin {
+
+TEST(ArgumentsTest, PositionalValues) {
+  Arguments arguments;
+  arguments.Reset(4);
+
+  EXPECT_EQ(4u, arguments.size());
+  EXPECT_EQ(-1, arguments.GetInteger(0));
+
+  arguments.SetInteger(0, 42);
+  arguments.SetFloat(1, 1.5f);
+  arguments.SetString(2, "Russell");
+  arguments.SetArray(3, { 1, 2, 3 });
+
+  EXPECT_EQ(42, arguments.GetInteger(0));
+  EXPECT_EQ(1.5f, arguments.GetFloat(1));
+  EXPECT_EQ("Russell", arguments.GetString(2));
+  EXPECT_EQ(3u, arguments.GetArray(3).size());
+
+  // Values of a different type, or out of bounds, return defaults.
+  EXPECT_EQ(-1.0f, arguments.GetFloat(0));
+  EXPECT_EQ("", arguments.GetString(1));
+  EXPECT_EQ(-1, arguments.GetInteger(4));
+}
+
+TEST(ArgumentsTest, ResetAndCopy) {
+  Arguments arguments;
+  arguments.Reset(2);
+  arguments.SetInteger(0, 7);
+  arguments.SetString(1, "Gunther");
+
+  Arguments copy = arguments.Copy();
+
+  arguments.Reset(1);
+  EXPECT_EQ(1u, arguments.size());
+  EXPECT_EQ(-1, arguments.GetInteger(0));
+  EXPECT_EQ("", arguments.GetString(1));
+
+  arguments.SetString(0, "Luce");
+  EXPECT_EQ("Luce", arguments.GetString(0));
+
+  ASSERT_EQ(2u, copy.size());
+  EXPECT_EQ(7, copy.GetInteger(0));
+  EXPECT_EQ("Gunther", copy.GetString(1));
+}
+
+}  // namespace plugin
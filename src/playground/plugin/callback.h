@@ -5,6 +5,7 @@
 #ifndef PLAYGROUND_PLUGIN_CALLBACK_H_
 #define PLAYGROUND_PLUGIN_CALLBACK_H_
 
+#include <stdint.h>
 #include <string>
 #include <vector>
 #include <utility>
@@ -16,7 +17,41 @@ namespace plugin {
 enum CallbackArgumentType {
   ARGUMENT_TYPE_INT,
   ARGUMENT_TYPE_FLOAT,
-  ARGUMENT_TYPE_STRING
+  ARGUMENT_TYPE_STRING,
+
+  // Array of cells, the length of which is given by another argument. Declared through the
+  // SizedArray annotation, as arrays are indistinguishable from strings in Pawn.
+  ARGUMENT_TYPE_ARRAY
+};
+
+// Operations through which the arguments of an intercepted callback are read from the Pawn stack.
+enum CallbackDecoderOperation : uint8_t {
+  DECODE_INT,
+  DECODE_FLOAT,
+  DECODE_STRING,
+  DECODE_SIZED_ARRAY
+};
+
+// A single step in the decoder plan of a callback. Step N decodes the Nth argument.
+struct CallbackDecoderStep {
+  CallbackDecoderOperation operation;
+
+  // Index of the argument that holds the length of the array, for DECODE_SIZED_ARRAY.
+  uint16_t size_index;
+};
+
+// Policies determining what happens when a deferred event is received while its queue is full.
+enum DeferredPolicy {
+  // The oldest queued event will be dropped in favour of the new one.
+  DEFERRED_POLICY_DROP_OLDEST,
+
+  // The new event will be dropped.
+  DEFERRED_POLICY_DROP_NEWEST,
+
+  // Events are merged with the queued event that shares its first argument, e.g. the playerid, so
+  // that only the latest values for each player are retained. The oldest queued event will be
+  // dropped when an event for another player is received while the queue is full.
+  DEFERRED_POLICY_LATEST_PER_PLAYER
 };
 
 // Structure representing a parsed Callback with all arguments and known annotations. Note
@@ -24,19 +59,42 @@ enum CallbackArgumentType {
 struct Callback {
   Callback() = default;
   Callback(const Callback& other) {
+    id = other.id;
     name = other.name;
     arguments = other.arguments;
+    decoder = other.decoder;
     cancelable = other.cancelable;
     deferred = other.deferred;
+    deferred_limit = other.deferred_limit;
+    deferred_policy = other.deferred_policy;
     return_value = other.return_value;
+    coalesce_index = other.coalesce_index;
+    coalesce_window = other.coalesce_window;
+    sample_rate = other.sample_rate;
   }
 
+  // Index of the callback in the list of parsed callbacks, usable as a dense identifier.
+  size_t id = 0;
+
   std::string name;
   std::vector<std::pair<std::string, CallbackArgumentType>> arguments;
 
+  // Plan for decoding the arguments from the Pawn stack, compiled when parsing the callback.
+  std::vector<CallbackDecoderStep> decoder;
+
   bool cancelable = false;
   bool deferred = false;
+  size_t deferred_limit = 0;  // zero means the default limit
+  DeferredPolicy deferred_policy = DEFERRED_POLICY_DROP_OLDEST;
   int return_value = 0;
+
+  // Index of the argument on which events will be coalesced, or -1 when they're not coalesced,
+  // and the window, in milliseconds, during which only the latest event will be retained.
+  int coalesce_index = -1;
+  double coalesce_window = 0;
+
+  // Only one in every |sample_rate| invocations of the callback will be forwarded.
+  uint32_t sample_rate = 1;
 };
 
 }  // namespace plugin
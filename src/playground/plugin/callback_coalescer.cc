@@ -0,0 +1,124 @@
+// Copyright 2020 Las Venturas Playground. All rights reserved.
+// Use of this source code is governed by the MIT license, a copy of which can
+// be found in the LICENSE file.
+
+#include "plugin/callback_coalescer.h"
+
+#include <algorithm>
+
+#include "base/logging.h"
+#include "plugin/callback.h"
+
+namespace plugin {
+
+CallbackCoalescer::CallbackCoalescer() = default;
+
+CallbackCoalescer::~CallbackCoalescer() = default;
+
+void CallbackCoalescer::Add(const Callback& callback, const Arguments& arguments,
+                            double current_time) {
+  DCHECK(callback.coalesce_index >= 0);
+
+  const uint32_t value = static_cast<uint32_t>(arguments.GetInteger(callback.coalesce_index));
+  const uint64_t key = (static_cast<uint64_t>(callback.id) << 32) | value;
+
+  size_t index = 0;
+
+  auto index_iter = entry_indices_.find(key);
+  if (index_iter == entry_indices_.end()) {
+    index = entries_.size();
+    const bool player_key = callback.arguments[callback.coalesce_index].first == "playerid";
+
+    entries_.push_back(Entry { &callback, Arguments(), 0, false, player_key });
+    entry_indices_.emplace(key, index);
+  } else {
+    index = index_iter->second;
+  }
+
+  Entry& entry = entries_[index];
+  entry.arguments.CopyFrom(arguments);
+
+  if (entry.pending) {
+    ++coalesced_;
+    return;
+  }
+
+  entry.deadline = current_time + callback.coalesce_window;
+  entry.pending = true;
+
+  pending_indices_.push_back(index);
+  ++pending_;
+}
+
+size_t CallbackCoalescer::Flush(double current_time, const Dispatcher& dispatcher) {
+  if (pending_indices_.empty())
+    return 0;
+
+  // Move the pending entries aside, as forwarding invocations may cause new ones to be added.
+  flushing_indices_.swap(pending_indices_);
+
+  size_t forwarded = 0;
+  size_t retained = 0;
+
+  for (size_t position = 0; position < flushing_indices_.size(); ++position) {
+    const size_t index = flushing_indices_[position];
+
+    Entry& entry = entries_[index];
+    if (!entry.pending)
+      continue;  // the entry has been discarded while forwarding another invocation
+
+    if (entry.deadline > current_time) {
+      flushing_indices_[retained++] = index;
+      continue;
+    }
+
+    entry.pending = false;
+    --pending_;
+
+    flushing_arguments_.CopyFrom(entry.arguments);
+
+    dispatcher(*entry.callback, flushing_arguments_);
+    ++forwarded;
+  }
+
+  // Entries that are not due yet opened their windows before the ones that were added while
+  // forwarding invocations, so they have to remain in front of them.
+  flushing_indices_.resize(retained);
+  flushing_indices_.insert(flushing_indices_.end(), pending_indices_.begin(),
+                           pending_indices_.end());
+
+  pending_indices_.swap(flushing_indices_);
+  flushing_indices_.clear();
+
+  return forwarded;
+}
+
+size_t CallbackCoalescer::DiscardPlayer(int32_t player_id) {
+  size_t discarded = 0;
+
+  auto discard = [&](size_t index) {
+    Entry& entry = entries_[index];
+    if (!entry.pending || !entry.player_key)
+      return false;
+
+    if (entry.arguments.GetInteger(entry.callback->coalesce_index) != player_id)
+      return false;
+
+    entry.pending = false;
+    --pending_;
+    ++discarded;
+    return true;
+  };
+
+  // Entries that are being flushed will be skipped by Flush() once they're no longer pending.
+  for (size_t index : flushing_indices_)
+    discard(index);
+
+  pending_indices_.erase(
+      std::remove_if(pending_indices_.begin(), pending_indices_.end(), discard),
+      pending_indices_.end());
+
+  return discarded;
+}
+
+}  // namespace plugin
@@ -0,0 +1,84 @@
+// Copyright 2020 Las Venturas Playground. All rights reserved.
+// Use of this source code is governed by the MIT license, a copy of which can
+// be found in the LICENSE file.
+
+#ifndef PLAYGROUND_PLUGIN_CALLBACK_COALESCER_H_
+#define PLAYGROUND_PLUGIN_CALLBACK_COALESCER_H_
+
+#include <stdint.h>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+#include "base/macros.h"
+#include "plugin/arguments.h"
+
+namespace plugin {
+
+struct Callback;
+
+// Coalesces the invocations of high-frequency callbacks, as declared through the Coalesce and
+// Window annotations. The first invocation for a given key (the value of the callback's coalesce
+// argument, e.g. the playerid) opens a window, during which later invocations replace the values
+// of the pending one. The latest values will be forwarded once the window has elapsed.
+//
+// Storage for pending invocations is retained once they've been forwarded, so that coalescing does
+// not need heap allocations in steady state.
+class CallbackCoalescer {
+ public:
+  // Function through which coalesced invocations will be forwarded.
+  using Dispatcher = std::function<void(const Callback& callback, const Arguments& arguments)>;
+
+  CallbackCoalescer();
+  ~CallbackCoalescer();
+
+  // Adds an invocation of |callback| with |arguments| at |current_time|, in milliseconds. The
+  // |callback| must be coalesced, and has to outlive this instance.
+  void Add(const Callback& callback, const Arguments& arguments, double current_time);
+
+  // Forwards the latest invocations whose window has elapsed by |current_time| to |dispatcher|,
+  // in the order in which their windows were opened. Returns the number of forwarded invocations.
+  size_t Flush(double current_time, const Dispatcher& dispatcher);
+
+  // Discards the pending invocations whose coalesce argument is the playerid and equals
+  // |player_id|, as the player has disconnected. Returns the number of discarded invocations.
+  size_t DiscardPlayer(int32_t player_id);
+
+  // Returns the number of invocations that have been merged in to a pending one.
+  size_t coalesced() const { return coalesced_; }
+
+  // Returns the number of invocations that are pending to be forwarded.
+  size_t size() const { return pending_; }
+
+ private:
+  struct Entry {
+    const Callback* callback;
+    Arguments arguments;
+
+    double deadline;
+    bool pending;
+
+    // Whether the coalesce argument of the |callback| is the playerid.
+    bool player_key;
+  };
+
+  // Entries for each of the keys that have been seen, and a map from the key to their index.
+  std::vector<Entry> entries_;
+  std::unordered_map<uint64_t, size_t> entry_indices_;
+
+  // Indices of the entries that are pending, in the order in which their windows were opened.
+  std::vector<size_t> pending_indices_;
+  std::vector<size_t> flushing_indices_;
+
+  // Arguments of the invocation that's being forwarded, as callbacks may be coalesced while doing so.
+  Arguments flushing_arguments_;
+
+  size_t coalesced_ = 0;
+  size_t pending_ = 0;
+
+  DISALLOW_COPY_AND_ASSIGN(CallbackCoalescer);
+};
+
+}  // namespace plugin
+
+#endif  // PLAYGROUND_PLUGIN_CALLBACK_COALESCER_H_
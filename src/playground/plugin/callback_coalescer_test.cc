@@ -0,0 +1,167 @@
+// Copyright 2020 Las Venturas Playground. All rights reserved.
+// Use of this source code is governed by the MIT license, a copy of which can
+// be found in the LICENSE file.
+
+#include "plugin/callback_coalescer.h"
+
+#include "gtest/gtest.h"
+#include "plugin/callback.h"
+
+namespace plugin {
+
+TEST(CallbackCoalescerTest, ForwardsLatestPerKey) {
+  Callback callback;
+  callback.id = 4;
+  callback.name = "OnPlayerWeaponShot";
+  callback.arguments.push_back(std::make_pair("playerid", ARGUMENT_TYPE_INT));
+  callback.arguments.push_back(std::make_pair("hittype", ARGUMENT_TYPE_INT));
+  callback.coalesce_index = 0;
+  callback.coalesce_window = 50;
+
+  CallbackCoalescer coalescer;
+  Arguments arguments;
+  arguments.Reset(2);
+
+  auto add = [&](int player_id, int hit_type, double time) {
+    arguments.SetInteger(0, player_id);
+    arguments.SetInteger(1, hit_type);
+    coalescer.Add(callback, arguments, time);
+  };
+
+  add(1, 10, 0);
+  add(2, 20, 10);
+  add(1, 11, 20);
+  add(1, 12, 30);
+
+  EXPECT_EQ(2u, coalescer.size());
+  EXPECT_EQ(2u, coalescer.coalesced());
+
+  std::vector<std::pair<int, int>> forwarded;
+  auto dispatcher = [&](const Callback& forwarded_callback, const Arguments& forwarded_arguments) {
+    EXPECT_EQ(&callback, &forwarded_callback);
+    forwarded.push_back(std::make_pair(forwarded_arguments.GetInteger(0),
+                                       forwarded_arguments.GetInteger(1)));
+  };
+
+  EXPECT_EQ(0u, coalescer.Flush(49, dispatcher));
+  EXPECT_EQ(1u, coalescer.Flush(50, dispatcher));
+
+  ASSERT_EQ(1u, forwarded.size());
+  EXPECT_EQ(std::make_pair(1, 12), forwarded[0]);
+
+  // Player 1 opens a new window, while player 2's window elapses.
+  add(1, 13, 55);
+
+  EXPECT_EQ(1u, coalescer.Flush(60, dispatcher));
+  ASSERT_EQ(2u, forwarded.size());
+  EXPECT_EQ(std::make_pair(2, 20), forwarded[1]);
+
+  EXPECT_EQ(1u, coalescer.Flush(105, dispatcher));
+  ASSERT_EQ(3u, forwarded.size());
+  EXPECT_EQ(std::make_pair(1, 13), forwarded[2]);
+
+  EXPECT_EQ(0u, coalescer.size());
+}
+
+TEST(CallbackCoalescerTest, RetainsWindowOrderWhenAddingDuringFlush) {
+  Callback callback;
+  callback.id = 2;
+  callback.name = "OnVehicleDamageStatusUpdate";
+  callback.arguments.push_back(std::make_pair("vehicleid", ARGUMENT_TYPE_INT));
+  callback.coalesce_index = 0;
+  callback.coalesce_window = 50;
+
+  Callback slow_callback;
+  slow_callback.id = 3;
+  slow_callback.name = "OnUnoccupiedVehicleUpdate";
+  slow_callback.arguments.push_back(std::make_pair("vehicleid", ARGUMENT_TYPE_INT));
+  slow_callback.coalesce_index = 0;
+  slow_callback.coalesce_window = 100;
+
+  CallbackCoalescer coalescer;
+  Arguments arguments;
+  arguments.Reset(1);
+
+  auto add = [&](const Callback& added_callback, int vehicle_id, double time) {
+    arguments.SetInteger(0, vehicle_id);
+    coalescer.Add(added_callback, arguments, time);
+  };
+
+  add(callback, 1, 0);
+  add(slow_callback, 2, 0);
+
+  // Forwarding the first invocation opens a window for vehicle 3, which happens after the window
+  // for vehicle 2 had been opened. The latter is not due yet.
+  std::vector<int> forwarded;
+  auto dispatcher = [&](const Callback& forwarded_callback, const Arguments& forwarded_arguments) {
+    forwarded.push_back(forwarded_arguments.GetInteger(0));
+    if (forwarded_arguments.GetInteger(0) == 1)
+      add(slow_callback, 3, 50);
+  };
+
+  EXPECT_EQ(1u, coalescer.Flush(50, dispatcher));
+  EXPECT_EQ(2u, coalescer.size());
+
+  EXPECT_EQ(2u, coalescer.Flush(150, dispatcher));
+  ASSERT_EQ(3u, forwarded.size());
+  EXPECT_EQ(1, forwarded[0]);
+  EXPECT_EQ(2, forwarded[1]);
+  EXPECT_EQ(3, forwarded[2]);
+}
+
+TEST(CallbackCoalescerTest, DiscardsDisconnectedPlayer) {
+  Callback callback;
+  callback.id = 4;
+  callback.name = "OnPlayerWeaponShot";
+  callback.arguments.push_back(std::make_pair("playerid", ARGUMENT_TYPE_INT));
+  callback.coalesce_index = 0;
+  callback.coalesce_window = 50;
+
+  Callback vehicle_callback;
+  vehicle_callback.id = 2;
+  vehicle_callback.name = "OnVehicleDamageStatusUpdate";
+  vehicle_callback.arguments.push_back(std::make_pair("vehicleid", ARGUMENT_TYPE_INT));
+  vehicle_callback.coalesce_index = 0;
+  vehicle_callback.coalesce_window = 50;
+
+  CallbackCoalescer coalescer;
+  Arguments arguments;
+  arguments.Reset(1);
+
+  auto add = [&](const Callback& added_callback, int value, double time) {
+    arguments.SetInteger(0, value);
+    coalescer.Add(added_callback, arguments, time);
+  };
+
+  add(vehicle_callback, 1, 0);
+  add(callback, 1, 0);
+  add(callback, 2, 0);
+
+  // Only invocations keyed on the disconnecting player are discarded, not those for vehicle 1.
+  EXPECT_EQ(1u, coalescer.DiscardPlayer(1));
+  EXPECT_EQ(0u, coalescer.DiscardPlayer(1));
+  EXPECT_EQ(2u, coalescer.size());
+
+  std::vector<std::pair<size_t, int>> forwarded;
+  auto dispatcher = [&](const Callback& forwarded_callback, const Arguments& forwarded_arguments) {
+    forwarded.push_back(std::make_pair(forwarded_callback.id, forwarded_arguments.GetInteger(0)));
+
+    // Player 2 disconnects while the invocation for vehicle 1 is being forwarded.
+    if (forwarded_callback.id == vehicle_callback.id)
+      coalescer.DiscardPlayer(2);
+  };
+
+  // Player 2 disconnects during the flush, so their invocation must not be forwarded anymore.
+  EXPECT_EQ(1u, coalescer.Flush(50, dispatcher));
+  ASSERT_EQ(1u, forwarded.size());
+  EXPECT_EQ(std::make_pair(vehicle_callback.id, 1), forwarded[0]);
+  EXPECT_EQ(0u, coalescer.size());
+
+  // The player's window can be opened again, e.g. when another player connects with their Id.
+  add(callback, 2, 60);
+  EXPECT_EQ(1u, coalescer.Flush(110, dispatcher));
+  ASSERT_EQ(2u, forwarded.size());
+  EXPECT_EQ(std::make_pair(callback.id, 2), forwarded[1]);
+}
+
+}  // namespace plugin
@@ -4,6 +4,8 @@
 
 #include "plugin/callback_hook.h"
 
+#include <algorithm>
+
 #include "base/logging.h"
 #include "plugin/arguments.h"
 #include "plugin/callback_parser.h"
@@ -75,9 +77,9 @@ int CallbackHook::OnExecute(AMX* amx, int* retval, int index) {
   if (g_ignore_depth > 0) {
     // Ignore the callback altogether, as part of the plugin relies on this.
 
-    auto interceptor_iter = intercept_indices_.find(index);
-    if (interceptor_iter != intercept_indices_.end()) {
-      LOG(WARNING) << "Callback (" << interceptor_iter->second->name << ") ignored << "
+    const Callback* callback = GetInterceptedCallback(index);
+    if (callback) {
+      LOG(WARNING) << "Callback (" << callback->name << ") ignored << "
                       "because a ScopedIgnore is in place.";
     } else {
       LOG(WARNING) << "Callback (" << index << ") ignored because a ScopedIgnore is in place.";
@@ -86,10 +88,10 @@ int CallbackHook::OnExecute(AMX* amx, int* retval, int index) {
     OnGamemodeLoaded(amx);
   } else if (gamemode_ == amx) {
     if (index != on_player_update_index_) {
-      auto interceptor_iter = intercept_indices_.find(index);
-      if (interceptor_iter != intercept_indices_.end()) {
+      const Callback* callback = GetInterceptedCallback(index);
+      if (callback) {
         ScopedReentrancyLock reentrancy_lock;
-        if (DoIntercept(amx, retval, *interceptor_iter->second))
+        if (DoIntercept(amx, retval, *callback))
           return AMX_ERR_NONE;
       }
     } else {
@@ -98,13 +100,19 @@ int CallbackHook::OnExecute(AMX* amx, int* retval, int index) {
   }
 
   // Trampoline back to the original amx_Exec function that we intercepted.
-  return ((amx_Exec_t) hook_->GetTrampoline())(amx, retval, index);
+  const int result = ((amx_Exec_t) hook_->GetTrampoline())(amx, retval, index);
+
+  delegate_->OnPawnExecuted();
+  return result;
 }
 
 bool CallbackHook::DoIntercept(AMX* amx, int* retval, const Callback& callback) {
   DCHECK(delegate_);
 
-  static Arguments arguments;
+  // Only forward one in every |sample_rate| invocations of sampled callbacks. This is decided
+  // before decoding the arguments, as that's the expensive part of intercepting a callback.
+  if (callback.sample_rate > 1 && sample_counters_[callback.id]++ % callback.sample_rate)
+    return false;
 
   // Do a sanity check on the number of available arguments on the stack. We don't want to overrun
   // in stack space that's not reserved for invoking the actual callback.
@@ -114,47 +122,45 @@ bool CallbackHook::DoIntercept(AMX* amx, int* retval, const Callback& callback)
     return false;
   }
 
-  size_t index = 0;
-  size_t cac_OnMemoryRead_size = 0;
-
-  arguments.clear();
-  for (const auto& argument : callback.arguments) {
-    // Special case "content" from the CAC_OnMemoryRead callback, which is given as an array and can
-    // contain NULL characters, which would fail with ReadStringFromAmx.
-    if (callback.name == "CAC_OnMemoryRead") {
-      if (argument.first == "size") {
-        cac_OnMemoryRead_size = ReadIntFromStack(amx, index);
-      } else if (argument.first == "content") {
-        int array_index = ReadIntFromStack(amx, index);
-
-        arguments.AddArray(
-            argument.first,
-            ReadArrayFromAmx(amx, array_index, cac_OnMemoryRead_size, &array_buffer_));
-
-        ++index;
-        continue;
-      }
-    }
+  // Intercepted callbacks nest when JavaScript calls in to Pawn, so every level of re-entrancy
+  // decodes in to its own instance: lazy events of the outer levels still refer to theirs.
+  if (intercept_depth_ == arguments_.size())
+    arguments_.emplace_back(new Arguments);
+
+  Arguments& arguments = *arguments_[intercept_depth_];
 
-    switch (argument.second) {
-    case ARGUMENT_TYPE_INT:
-      arguments.AddInteger(argument.first, ReadIntFromStack(amx, index));
+  // Decode the arguments by executing the callback's decoder plan, one step per argument.
+  arguments.Reset(callback.decoder.size());
+  for (size_t index = 0; index < callback.decoder.size(); ++index) {
+    const CallbackDecoderStep& step = callback.decoder[index];
+    switch (step.operation) {
+    case DECODE_INT:
+      arguments.SetInteger(index, ReadIntFromStack(amx, index));
       break;
-    case ARGUMENT_TYPE_FLOAT:
-      arguments.AddFloat(argument.first, ReadFloatFromStack(amx, index));
+    case DECODE_FLOAT:
+      arguments.SetFloat(index, ReadFloatFromStack(amx, index));
       break;
-    case ARGUMENT_TYPE_STRING:
+    case DECODE_STRING:
       {
         int string_index = ReadIntFromStack(amx, index);
-        arguments.AddString(argument.first, ReadStringFromAmx(amx, string_index, &text_buffer_));
+        arguments.SetString(index, ReadStringFromAmx(amx, string_index, &text_buffer_));
       }
       break;
-    }
+    case DECODE_SIZED_ARRAY:
+      {
+        const int array_size = std::max(ReadIntFromStack(amx, step.size_index), 0);
+        const int array_index = ReadIntFromStack(amx, index);
 
-    ++index;
+        arguments.SetArray(index, ReadArrayFromAmx(amx, array_index, array_size, &array_buffer_));
+      }
+      break;
+    }
   }
 
-  const bool result = delegate_->OnCallbackIntercepted(callback.name, arguments, callback.deferred);
+  ++intercept_depth_;
+  const bool result = delegate_->OnCallbackIntercepted(callback, arguments);
+  --intercept_depth_;
+
   if (result && retval)
     *retval = callback.return_value;
 
@@ -177,6 +183,9 @@ void CallbackHook::OnGamemodeLoaded(AMX* amx) {
     return;
   }
 
+  intercept_indices_.assign(public_count, nullptr);
+  sample_counters_.assign(callback_parser_->size(), 0);
+
   char callback_name[sNAMEMAX + 1] = { 0 };
   for (int index = 0; index < public_count; ++index) {
     if (amx_GetPublic(amx, index, callback_name) != AMX_ERR_NONE) {
@@ -8,7 +8,6 @@
 #include <memory>
 #include <stdint.h>
 #include <string>
-#include <unordered_map>
 #include <vector>
 
 typedef struct tagAMX AMX;
@@ -40,7 +39,10 @@ class CallbackHook {
 
     // Called when a callback to the gamemode has been intercepted. Returning true will block
     // the callback from being invoked in the Pawn runtime.
-    virtual bool OnCallbackIntercepted(const std::string& callback, const Arguments& arguments, bool deferred) = 0;
+    virtual bool OnCallbackIntercepted(const Callback& callback, const Arguments& arguments) = 0;
+
+    // Called when Pawn code has been executed by the runtime, which may have changed state.
+    virtual void OnPawnExecuted() = 0;
   };
 
   // Place this on the stack to ignore interceptable callbacks until it goes out of scope.
@@ -72,6 +74,13 @@ class CallbackHook {
   // Called when the OnPlayerUpdate callback has been intercepted by the |amx| runtime.
   int DoInterceptPlayerUpdate(AMX* amx);
 
+  // Returns the callback to intercept for the public function at |index|, or a nullptr when calls
+  // to the function should not be intercepted. Negative indices never will be.
+  const Callback* GetInterceptedCallback(int index) const {
+    return static_cast<size_t>(index) < intercept_indices_.size() ? intercept_indices_[index]
+                                                                  : nullptr;
+  }
+
   // Weak reference. Will usually own this instance.
   Delegate* delegate_;
 
@@ -81,8 +90,19 @@ class CallbackHook {
   // The hook which will be installed in the SA-MP server's memory.
   std::unique_ptr<SubHook> hook_;
 
-  // Mapping of function indices to the callback format that is to be intercepted.
-  std::unordered_map<int, const Callback*> intercept_indices_;
+  // Mapping of function indices to the callback format that is to be intercepted, sized by the
+  // number of public functions in the gamemode. Contains a nullptr for other functions.
+  std::vector<const Callback*> intercept_indices_;
+
+  // Number of invocations of each of the callbacks, indexed by Id, for sampling them.
+  std::vector<uint32_t> sample_counters_;
+
+  // Arguments for each level of intercepted callbacks, indexed by |intercept_depth_|. Retained
+  // between invocations so that their storage can be reused.
+  std::vector<std::unique_ptr<Arguments>> arguments_;
+
+  // Number of intercepted callbacks that are currently being dispatched to the delegate.
+  size_t intercept_depth_ = 0;
 
   // Index assigned to the OnPlayerUpdate function.
   int on_player_update_index_;
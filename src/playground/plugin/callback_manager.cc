@@ -24,46 +24,96 @@ void CallbackManager::OnGamemodeChanged(AMX* gamemode) {
   callback_index_cache_.clear();
 }
 
-int CallbackManager::CallPublic(const std::string& function_name, const char* format, void** arguments) {
+int CallbackManager::CallPublic(const std::string& function_name, const char* format, void** arguments,
+                                bool* success) {
+  if (success)
+    *success = false;
+
   if (!gamemode_)
     return -1;
 
   if (ScopedReentrancyLock::IsReentrant())
     LOG(WARNING) << "Warning: Re-entrant call to public function " << function_name;
 
+  const int callback_index = GetPublicIndex(function_name);
+
+  // Bail out if the public function does not exist in the |gamemode_|.
+  if (callback_index == -1)
+    return -1;
+
+  const size_t param_count = format ? strlen(format) : 0;
+  if (!IsValidFormat(function_name, format, param_count))
+    return -1;
+
+  return ExecutePublic(callback_index, function_name, format, param_count, arguments, success);
+}
+
+bool CallbackManager::CallPublicBatch(const std::string& function_name, const char* format,
+                                      void** arguments, size_t count, int32_t* results) {
+  if (!gamemode_)
+    return false;
+
+  if (ScopedReentrancyLock::IsReentrant())
+    LOG(WARNING) << "Warning: Re-entrant call to public function " << function_name;
+
+  const int callback_index = GetPublicIndex(function_name);
+  if (callback_index == -1)
+    return false;
+
+  const size_t param_count = format ? strlen(format) : 0;
+  if (!IsValidFormat(function_name, format, param_count))
+    return false;
+
+  for (size_t invocation = 0; invocation < count; ++invocation) {
+    results[invocation] = ExecutePublic(callback_index, function_name, format, param_count,
+                                        arguments + invocation * param_count);
+  }
+
+  return true;
+}
+
+int CallbackManager::GetPublicIndex(const std::string& function_name) {
   int callback_index = -1;
-  
+
   // Read the callback's index from the cache (O(n)), or find it in the |gamemode_| which is
   // an O(log n) operation. This does not guarantee that the callback is valid.
   auto callback_index_iter = callback_index_cache_.find(function_name);
-  if (callback_index_iter == callback_index_cache_.end()) {
-    if (amx_FindPublic(gamemode_, function_name.c_str(), &callback_index) != AMX_ERR_NONE) {
-      LOG(WARNING) << "Unable to determine the callback index of " << function_name;
-      return -1;
-    }
-
-    callback_index_cache_[function_name] = callback_index;
-  } else {
-    callback_index = callback_index_iter->second;
-  }
+  if (callback_index_iter != callback_index_cache_.end())
+    return callback_index_iter->second;
 
-  // Bail out if the public function does not exist in the |gamemode_|.
-  if (callback_index == -1)
+  if (amx_FindPublic(gamemode_, function_name.c_str(), &callback_index) != AMX_ERR_NONE) {
+    LOG(WARNING) << "Unable to determine the callback index of " << function_name;
     return -1;
+  }
 
-  size_t param_count = format ? strlen(format) : 0;
-  int return_value = -1;
+  callback_index_cache_[function_name] = callback_index;
+  return callback_index;
+}
 
+bool CallbackManager::IsValidFormat(const std::string& function_name, const char* format,
+                                    size_t param_count) const {
   // Parameters of the reference type ('r') are prohibited, since they're uncommon for callbacks and
   // would require significant implementation complexity. Let's just use return values.
   for (size_t param = 0; param < param_count; ++param) {
     if (format[param] == 'r') {
       LOG(WARNING) << "Unable to invoke " << function_name << ": illegal reference parameter at index " << param;
-      return return_value;
+      return false;
     }
   }
 
-  std::vector<cell> cleanup_list;
+  return true;
+}
+
+int CallbackManager::ExecutePublic(int callback_index, const std::string& function_name,
+                                   const char* format, size_t param_count, void** arguments,
+                                   bool* success) {
+  int return_value = -1;
+
+  if (success)
+    *success = false;
+
+  // Calls may be re-entrant, so only the allocations made for this call will be released.
+  const size_t cleanup_offset = cleanup_list_.size();
 
   // Parameters will have to be pushed in reverse order.
   for (int param = param_count - 1; param >= 0; --param) {
@@ -81,7 +131,7 @@ int CallbackManager::CallPublic(const std::string& function_name, const char* fo
       {
         cell amx_addr, *physical_cell = nullptr;
         amx_PushString(gamemode_, &amx_addr, &physical_cell, reinterpret_cast<char*>(arguments[param]), 0, 0);
-        cleanup_list.push_back(amx_addr);
+        cleanup_list_.push_back(amx_addr);
       }
       break;
     case 'a':
@@ -95,7 +145,7 @@ int CallbackManager::CallPublic(const std::string& function_name, const char* fo
 
         cell amx_addr, *physical_cell = nullptr;
         amx_PushArray(gamemode_, &amx_addr, &physical_cell, reinterpret_cast<cell*>(arguments[param]), array_size);
-        cleanup_list.push_back(amx_addr);
+        cleanup_list_.push_back(amx_addr);
       }
       break;
     default:
@@ -112,13 +162,16 @@ int CallbackManager::CallPublic(const std::string& function_name, const char* fo
     int result = amx_Exec(gamemode_, &return_value, callback_index);
     if (result != AMX_ERR_NONE)
       LOG(WARNING) << "Unable to invoke " << function_name << ": AMX error occurred: " << result;
+    else if (success)
+      *success = true;
   }
 
 cleanup:
   // Cleanup all allocations made on the Pawn stack for strings and arrays.
-  for (cell amx_addr : cleanup_list)
-    amx_Release(gamemode_, amx_addr);
+  for (size_t index = cleanup_offset; index < cleanup_list_.size(); ++index)
+    amx_Release(gamemode_, cleanup_list_[index]);
 
+  cleanup_list_.resize(cleanup_offset);
   return return_value;
 }
 
@@ -5,8 +5,11 @@
 #ifndef PLAYGROUND_PLUGIN_CALLBACK_MANAGER_H_
 #define PLAYGROUND_PLUGIN_CALLBACK_MANAGER_H_
 
+#include <stddef.h>
+#include <stdint.h>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 typedef struct tagAMX AMX;
 
@@ -21,11 +24,37 @@ class CallbackManager {
   void OnGamemodeChanged(AMX* gamemode);
 
   // Calls |function_name| with |arguments| on the Pawn script that identified as the gamemode.
-  int CallPublic(const std::string& function_name, const char* format, void** arguments);
+  // Returns -1 when the function cannot be called, but the function may return -1 itself as well,
+  // so |success|, when given, will be set to whether the function was executed.
+  int CallPublic(const std::string& function_name, const char* format, void** arguments,
+                 bool* success = nullptr);
+
+  // Calls |function_name| |count| times, each with the next strlen(|format|) entries in |arguments|,
+  // and writes the return values to |results|. The callback's index is only resolved once. Returns
+  // whether the calls could be made, in which case |results| will have been written to.
+  bool CallPublicBatch(const std::string& function_name, const char* format, void** arguments,
+                       size_t count, int32_t* results);
 
  private:
+  // Returns the index of the public function named |function_name| in the |gamemode_|, or -1 when
+  // it does not exist.
+  int GetPublicIndex(const std::string& function_name);
+
+  // Returns whether |format| can be used to call a public function named |function_name|.
+  bool IsValidFormat(const std::string& function_name, const char* format, size_t param_count) const;
+
+  // Pushes |arguments| structured like |format| to the stack of the |gamemode_| and executes the
+  // public function at |callback_index|. Returns the value returned by the function, and sets
+  // |success|, when given, to whether it could be executed.
+  int ExecutePublic(int callback_index, const std::string& function_name, const char* format,
+                    size_t param_count, void** arguments, bool* success = nullptr);
+
   AMX* gamemode_;
 
+  // Addresses of strings and arrays pushed to the Pawn heap that have to be released after the
+  // call. Reused between calls, and used as a stack as calls may be re-entrant.
+  std::vector<int32_t> cleanup_list_;
+
   // Cache for maintaining a mapping between callback names and their indices in |gamemode_|.
   std::unordered_map<std::string, int> callback_index_cache_;
 };
@@ -17,8 +17,34 @@ namespace {
 
 // The known annotations as they will be parsed by ParseAnnotations().
 const char kAnnotationCancelable[] = "Cancelable";
+const char kAnnotationCoalesce[] = "Coalesce";
 const char kAnnotationDeferred[] = "Deferred";
+const char kAnnotationLimit[] = "Limit";
+const char kAnnotationPolicy[] = "Policy";
 const char kAnnotationReturnOne[] = "ReturnOne";
+const char kAnnotationSample[] = "Sample";
+const char kAnnotationSizedArray[] = "SizedArray";
+const char kAnnotationWindow[] = "Window";
+
+// The known values for the Policy annotation.
+const char kPolicyDropNewest[] = "drop-newest";
+const char kPolicyDropOldest[] = "drop-oldest";
+const char kPolicyLatestPerPlayer[] = "latest-per-player";
+
+// Maximum value of the Limit annotation, to bound the memory used by deferred event queues.
+const size_t kMaximumDeferredLimit = 1048576;
+
+// Maximum values of the Window (in milliseconds) and Sample annotations.
+const size_t kMaximumCoalesceWindow = 60000;
+const size_t kMaximumSampleRate = 65536;
+
+// Callbacks that may not be sampled, as the plugin relies on seeing every invocation of them. The
+// streamer, for example, maintains its set of tracked players based on these.
+const char* kUnsampledCallbacks[] = {
+  "OnPlayerConnect",
+  "OnPlayerDisconnect",
+  "OnPlayerStateChange",
+};
 
 // The whitespace characters as specified by CSS 2.1.
 const char kWhitespaceCharacters[] = "\x09\x0A\x0C\x0D\x20";
@@ -38,9 +64,39 @@ base::StringPiece Trim(const base::StringPiece& input) {
   return input.substr(first_good_char, last_good_char - first_good_char + 1);
 }
 
-// Parses any leading annotations in |line| and applies the known ones to |callback|. Returns
-// true unless there are annotations, and parsing of them fails.
-bool ParseAnnotations(base::StringPiece* line, Callback* callback) {
+// List of (array, size) argument names declared through the SizedArray annotation.
+using SizedArrayList = std::vector<std::pair<base::StringPiece, base::StringPiece>>;
+
+// Annotations that refer to arguments by name, which can only be applied once the arguments of the
+// callback have been parsed.
+struct ArgumentAnnotations {
+  SizedArrayList sized_arrays;
+  base::StringPiece coalesce_field;
+};
+
+// Parses |value| as a number between 1 and |maximum|, stored in |result|. Returns whether the
+// |value| is valid.
+bool ParseNumber(const base::StringPiece& value, size_t maximum, size_t* result) {
+  size_t number = 0;
+  for (size_t index = 0; index < value.length(); ++index) {
+    if (value[index] < '0' || value[index] > '9' || number > maximum)
+      return false;
+
+    number = number * 10 + (value[index] - '0');
+  }
+
+  if (!number || number > maximum)
+    return false;
+
+  *result = number;
+  return true;
+}
+
+// Parses any leading annotations in |line| and applies the known ones to |callback|. Annotations
+// that refer to arguments will be stored in |argument_annotations|, as arguments have not been
+// parsed yet. Returns true unless there are annotations, and parsing of them fails.
+bool ParseAnnotations(base::StringPiece* line, Callback* callback,
+                      ArgumentAnnotations* argument_annotations) {
   if (!line->starts_with("["))
     return true;  // there are no annotations.
 
@@ -59,6 +115,8 @@ bool ParseAnnotations(base::StringPiece* line, Callback* callback) {
     }
   }
 
+  bool has_deferred_options = false;
+
   // Iterate over the found annotations to identify the known ones, and mark them as such
   // in the |callback| passed on to this function.
   for (const auto& annotation : annotations) {
@@ -69,7 +127,83 @@ bool ParseAnnotations(base::StringPiece* line, Callback* callback) {
     else if (annotation == kAnnotationReturnOne)
       callback->return_value = 1;
 
-    // TODO: Parse additional annotations here.
+    // Annotations in the form of "Name=Value".
+    const size_t value_offset = annotation.find_first_of('=');
+    if (value_offset == base::StringPiece::npos)
+      continue;
+
+    const base::StringPiece name = Trim(annotation.substr(0, value_offset));
+    const base::StringPiece value = Trim(annotation.substr(value_offset + 1));
+
+    if (name == kAnnotationLimit) {
+      if (!ParseNumber(value, kMaximumDeferredLimit, &callback->deferred_limit)) {
+        LOG(WARNING) << "The Limit annotation must be a number between 1 and "
+                     << kMaximumDeferredLimit << ".";
+        return false;
+      }
+
+      has_deferred_options = true;
+
+    } else if (name == kAnnotationPolicy) {
+      if (value == kPolicyDropOldest) {
+        callback->deferred_policy = DEFERRED_POLICY_DROP_OLDEST;
+      } else if (value == kPolicyDropNewest) {
+        callback->deferred_policy = DEFERRED_POLICY_DROP_NEWEST;
+      } else if (value == kPolicyLatestPerPlayer) {
+        callback->deferred_policy = DEFERRED_POLICY_LATEST_PER_PLAYER;
+      } else {
+        LOG(WARNING) << "Unknown deferred event policy: " << value.as_string();
+        return false;
+      }
+
+      has_deferred_options = true;
+
+    } else if (name == kAnnotationSizedArray) {
+      const size_t size_offset = value.find_first_of(':');
+      if (size_offset == base::StringPiece::npos) {
+        LOG(WARNING) << "The SizedArray annotation must be in the form of SizedArray=array:size.";
+        return false;
+      }
+
+      argument_annotations->sized_arrays.push_back(
+          std::make_pair(Trim(value.substr(0, size_offset)), Trim(value.substr(size_offset + 1))));
+
+    } else if (name == kAnnotationCoalesce) {
+      argument_annotations->coalesce_field = value;
+
+    } else if (name == kAnnotationWindow) {
+      const base::StringPiece window =
+          value.ends_with("ms") ? Trim(value.substr(0, value.length() - 2)) : value;
+
+      size_t milliseconds = 0;
+      if (!ParseNumber(window, kMaximumCoalesceWindow, &milliseconds)) {
+        LOG(WARNING) << "The Window annotation must be a duration between 1ms and "
+                     << kMaximumCoalesceWindow << "ms.";
+        return false;
+      }
+
+      callback->coalesce_window = static_cast<double>(milliseconds);
+
+    } else if (name == kAnnotationSample) {
+      size_t sample_rate = 0;
+      if (!value.starts_with("1/") ||
+          !ParseNumber(Trim(value.substr(2)), kMaximumSampleRate, &sample_rate)) {
+        LOG(WARNING) << "The Sample annotation must be in the form of Sample=1/N.";
+        return false;
+      }
+
+      callback->sample_rate = static_cast<uint32_t>(sample_rate);
+    }
+  }
+
+  if (argument_annotations->coalesce_field.empty() != !callback->coalesce_window) {
+    LOG(WARNING) << "The Coalesce and Window annotations must be used together.";
+    return false;
+  }
+
+  if (callback->cancelable && (callback->coalesce_window || callback->sample_rate > 1)) {
+    LOG(WARNING) << "Cancelable callbacks cannot be coalesced or sampled.";
+    return false;
   }
 
   if (callback->cancelable && callback->deferred) {
@@ -77,6 +211,11 @@ bool ParseAnnotations(base::StringPiece* line, Callback* callback) {
     return false;
   }
 
+  if (has_deferred_options && !callback->deferred) {
+    LOG(WARNING) << "The Limit and Policy annotations only apply to deferred callbacks.";
+    return false;
+  }
+
   if ((*line)[index] != ']')
     return false;
 
@@ -120,6 +259,64 @@ bool ParseArgument(const base::StringPiece& input_argument, Callback* callback)
   return true;
 }
 
+// Returns the index of the argument named |name| in |callback|, or -1 if there is no such argument.
+int FindArgument(const Callback& callback, const base::StringPiece& name) {
+  for (size_t index = 0; index < callback.arguments.size(); ++index) {
+    if (name == callback.arguments[index].first)
+      return static_cast<int>(index);
+  }
+
+  return -1;
+}
+
+// Compiles the plan through which the arguments of |callback| will be decoded from the Pawn stack
+// when it gets intercepted, taking the |sized_arrays| in to account. Returns whether the plan
+// could be compiled, which requires the |sized_arrays| to refer to valid arguments.
+bool CompileDecoder(const SizedArrayList& sized_arrays, Callback* callback) {
+  callback->decoder.resize(callback->arguments.size());
+
+  for (size_t index = 0; index < callback->arguments.size(); ++index) {
+    CallbackDecoderStep& step = callback->decoder[index];
+    step.size_index = 0;
+
+    switch (callback->arguments[index].second) {
+    case ARGUMENT_TYPE_INT:
+      step.operation = DECODE_INT;
+      break;
+    case ARGUMENT_TYPE_FLOAT:
+      step.operation = DECODE_FLOAT;
+      break;
+    case ARGUMENT_TYPE_STRING:
+    case ARGUMENT_TYPE_ARRAY:
+      step.operation = DECODE_STRING;
+      break;
+    }
+  }
+
+  for (const auto& [array_name, size_name] : sized_arrays) {
+    const int array_index = FindArgument(*callback, array_name);
+    const int size_index = FindArgument(*callback, size_name);
+
+    if (array_index == -1 || callback->arguments[array_index].second != ARGUMENT_TYPE_STRING) {
+      LOG(WARNING) << "The SizedArray annotation must refer to an array argument (\""
+                   << array_name.as_string() << "[]\").";
+      return false;
+    }
+
+    if (size_index == -1 || callback->arguments[size_index].second != ARGUMENT_TYPE_INT) {
+      LOG(WARNING) << "The SizedArray annotation must refer to an integral size argument (\""
+                   << size_name.as_string() << "\").";
+      return false;
+    }
+
+    callback->arguments[array_index].second = ARGUMENT_TYPE_ARRAY;
+    callback->decoder[array_index].operation = DECODE_SIZED_ARRAY;
+    callback->decoder[array_index].size_index = static_cast<uint16_t>(size_index);
+  }
+
+  return true;
+}
+
 }  // namespace
 
 // static
@@ -180,6 +377,9 @@ bool CallbackParser::Parse(const std::string& content) {
     if (!ParseLine(line, &callback))
       return false;
 
+    callback.id = callbacks_.size();
+    callback_ids_.emplace(callback.name, callback.id);
+
     callbacks_.push_back(callback);
   }
 
@@ -188,9 +388,10 @@ bool CallbackParser::Parse(const std::string& content) {
 
 bool CallbackParser::ParseLine(const base::StringPiece& line, Callback* callback) const {
   Callback candidate_callback;
+  ArgumentAnnotations argument_annotations;
 
   base::StringPiece parsing_line(Trim(line));
-  if (!ParseAnnotations(&parsing_line, &candidate_callback)) {
+  if (!ParseAnnotations(&parsing_line, &candidate_callback, &argument_annotations)) {
     LOG(WARNING) << "Syntax error: Unable to parse annotations. (\"" << line << "\").";
     return false;
   }
@@ -212,6 +413,16 @@ bool CallbackParser::ParseLine(const base::StringPiece& line, Callback* callback
   Trim(parsing_line.substr(0, arguments_offset)).CopyToString(&candidate_callback.name);
   parsing_line.remove_prefix(arguments_offset + 1);
 
+  if (candidate_callback.sample_rate > 1) {
+    for (const char* unsampled_callback : kUnsampledCallbacks) {
+      if (candidate_callback.name == unsampled_callback) {
+        LOG(WARNING) << "The " << unsampled_callback << " callback cannot be sampled. (\""
+                     << line << "\").";
+        return false;
+      }
+    }
+  }
+
   if (parsing_line.ends_with(";"))
     parsing_line = Trim(parsing_line.substr(0, parsing_line.length() - 1));
 
@@ -234,23 +445,58 @@ bool CallbackParser::ParseLine(const base::StringPiece& line, Callback* callback
     parsing_line = Trim(parsing_line.substr(separator_offset + 1));
   }
 
+  if (!CompileDecoder(argument_annotations.sized_arrays, &candidate_callback)) {
+    LOG(WARNING) << "Unable to compile the argument decoder. (\"" << line << "\").";
+    return false;
+  }
+
+  if (candidate_callback.deferred && !argument_annotations.sized_arrays.empty()) {
+    LOG(WARNING) << "Deferred callbacks cannot have array arguments. (\"" << line << "\").";
+    return false;
+  }
+
+  if (!argument_annotations.coalesce_field.empty()) {
+    const int coalesce_index = FindArgument(candidate_callback, argument_annotations.coalesce_field);
+    if (coalesce_index == -1 ||
+        candidate_callback.arguments[coalesce_index].second != ARGUMENT_TYPE_INT) {
+      LOG(WARNING) << "The Coalesce annotation must refer to an integral argument. (\""
+                   << line << "\").";
+      return false;
+    }
+
+    candidate_callback.coalesce_index = coalesce_index;
+  }
+
+  if (candidate_callback.deferred_policy == DEFERRED_POLICY_LATEST_PER_PLAYER &&
+      (candidate_callback.arguments.empty() ||
+       candidate_callback.arguments[0].second != ARGUMENT_TYPE_INT)) {
+    LOG(WARNING) << "The latest-per-player policy requires an integral first argument. (\""
+                 << line << "\").";
+    return false;
+  }
+
   // Parsing of the callback was successful. Move the results to |callback|.
   callback->arguments.swap(candidate_callback.arguments);
+  callback->decoder.swap(candidate_callback.decoder);
   callback->name.swap(candidate_callback.name);
   callback->return_value = candidate_callback.return_value;
   callback->cancelable = candidate_callback.cancelable;
   callback->deferred = candidate_callback.deferred;
+  callback->deferred_limit = candidate_callback.deferred_limit;
+  callback->deferred_policy = candidate_callback.deferred_policy;
+  callback->coalesce_index = candidate_callback.coalesce_index;
+  callback->coalesce_window = candidate_callback.coalesce_window;
+  callback->sample_rate = candidate_callback.sample_rate;
 
   return true;
 }
 
 const Callback* CallbackParser::Find(const std::string& name) const {
-  for (const auto& callback : callbacks_) {
-    if (callback.name == name)
-      return &callback;
-  }
+  auto id_iter = callback_ids_.find(name);
+  if (id_iter == callback_ids_.end())
+    return nullptr;
 
-  return nullptr;
+  return &callbacks_[id_iter->second];
 }
 
 }  // namespace plugin
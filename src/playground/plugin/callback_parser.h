@@ -6,6 +6,7 @@
 #define PLAYGROUND_PLUGIN_CALLBACK_PARSER_H_
 
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "base/logging.h"
@@ -45,6 +46,30 @@ namespace plugin {
 // }
 //
 // Calling the preventDefault() method will prevent the gamemode from receiving the event.
+//
+// Callbacks annotated with [Deferred] are queued rather than dispatched, until JavaScript pulls
+// them through getDeferredEvents(). Their queues can be bounded with the following annotations:
+//
+//     [Deferred, Limit=512, Policy=latest-per-player] forward OnPlayerWeaponShot(playerid, ...);
+//
+// Limit sets the maximum number of queued events. Policy determines what happens to events over
+// the limit, and is one of "drop-oldest" (the default), "drop-newest" or "latest-per-player", the
+// latter of which merges events sharing the first argument in to the most recent values.
+//
+// High-frequency callbacks can be thinned out before they reach JavaScript. Coalesced callbacks
+// will only forward the latest event for each value of the named argument per window, whereas
+// sampled callbacks will only forward one in every N events:
+//
+//     [Coalesce=playerid, Window=50ms] forward OnPlayerWeaponShot(playerid, ...);
+//     [Sample=1/4] forward OnUnoccupiedVehicleUpdate(vehicleid, playerid, ...);
+//
+// Callbacks whose every invocation the plugin relies on, such as OnPlayerConnect, cannot be sampled.
+//
+// Array arguments are indistinguishable from strings in Pawn, so they have to be declared through
+// the SizedArray annotation, which names the array and the argument holding its length:
+//
+//     [SizedArray=content:size] forward CAC_OnMemoryRead(playerid, address, size, content[]);
+//
 // Other annotations may become available in the future, and will be documented here accordingly.
 class CallbackParser {
  public:
@@ -58,7 +83,7 @@ class CallbackParser {
 
   ~CallbackParser();
 
-  // TODO: This method is O(n), but could be O(1) by sacrificing some memory.
+  // Returns the callback named |name|, or a nullptr when no such callback has been defined.
   const Callback* Find(const std::string& name) const;
 
   size_t size() const { return callbacks_.size(); }
@@ -72,6 +97,9 @@ class CallbackParser {
   FRIEND_TEST(CallbackParserTest, ParseLineNoArguments);
   FRIEND_TEST(CallbackParserTest, ParseLineCancelableAnnotation);
   FRIEND_TEST(CallbackParserTest, ParseLineUnknownAnnotation);
+  FRIEND_TEST(CallbackParserTest, ParseLineDeferredAnnotations);
+  FRIEND_TEST(CallbackParserTest, ParseLineDecoder);
+  FRIEND_TEST(CallbackParserTest, ParseLineThrottlingAnnotations);
   FRIEND_TEST(CallbackParserTest, ParseLineOneArgument);
   FRIEND_TEST(CallbackParserTest, ParseLineMultipleArguments);
   FRIEND_TEST(CallbackParserTest, ParseWithWhitespace);
@@ -93,6 +121,9 @@ class CallbackParser {
   // Vector containing the callbacks which were parsed using this parser.
   std::vector<Callback> callbacks_;
 
+  // Map from the name of a callback to its index in |callbacks_|.
+  std::unordered_map<std::string, size_t> callback_ids_;
+
   DISALLOW_COPY_AND_ASSIGN(CallbackParser);
 };
 
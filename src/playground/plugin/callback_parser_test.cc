@@ -43,6 +43,81 @@ TEST(CallbackParserTest, ParseLineUnknownAnnotation) {
   EXPECT_TRUE(callback.cancelable);
 }
 
+TEST(CallbackParserTest, ParseLineDeferredAnnotations) {
+  Callback callback;
+
+  std::unique_ptr<CallbackParser> parser(new CallbackParser());
+  ASSERT_TRUE(parser->ParseLine(
+      "[Deferred, Limit=512, Policy=latest-per-player] forward OnPlayerShot(playerid, Float:x);",
+      &callback));
+
+  EXPECT_TRUE(callback.deferred);
+  EXPECT_EQ(512u, callback.deferred_limit);
+  EXPECT_EQ(DEFERRED_POLICY_LATEST_PER_PLAYER, callback.deferred_policy);
+
+  ASSERT_TRUE(parser->ParseLine("[Deferred, Policy=drop-newest] forward OnTick();", &callback));
+  EXPECT_EQ(0u, callback.deferred_limit);
+  EXPECT_EQ(DEFERRED_POLICY_DROP_NEWEST, callback.deferred_policy);
+
+  EXPECT_FALSE(parser->ParseLine("[Limit=512] forward OnTick();", &callback));
+  EXPECT_FALSE(parser->ParseLine("[Deferred, Limit=0] forward OnTick();", &callback));
+  EXPECT_FALSE(parser->ParseLine("[Deferred, Limit=many] forward OnTick();", &callback));
+  EXPECT_FALSE(parser->ParseLine("[Deferred, Policy=random] forward OnTick();", &callback));
+  EXPECT_FALSE(parser->ParseLine(
+      "[Deferred, Policy=latest-per-player] forward OnTick(Float:time);", &callback));
+}
+
+TEST(CallbackParserTest, ParseLineDecoder) {
+  Callback callback;
+
+  std::unique_ptr<CallbackParser> parser(new CallbackParser());
+  ASSERT_TRUE(parser->ParseLine(
+      "[SizedArray=content:size] forward OnRead(Float:x, text[], size, content[]);", &callback));
+
+  ASSERT_EQ(4u, callback.decoder.size());
+  EXPECT_EQ(DECODE_FLOAT, callback.decoder[0].operation);
+  EXPECT_EQ(DECODE_STRING, callback.decoder[1].operation);
+  EXPECT_EQ(DECODE_INT, callback.decoder[2].operation);
+  EXPECT_EQ(DECODE_SIZED_ARRAY, callback.decoder[3].operation);
+  EXPECT_EQ(2u, callback.decoder[3].size_index);
+
+  EXPECT_EQ(ARGUMENT_TYPE_ARRAY, callback.arguments[3].second);
+
+  EXPECT_FALSE(parser->ParseLine("[SizedArray=content] forward OnRead(content[]);", &callback));
+  EXPECT_FALSE(parser->ParseLine(
+      "[SizedArray=content:size] forward OnRead(Float:size, content[]);", &callback));
+  EXPECT_FALSE(parser->ParseLine(
+      "[SizedArray=content:size] forward OnRead(size, content);", &callback));
+  EXPECT_FALSE(parser->ParseLine(
+      "[Deferred, SizedArray=content:size] forward OnRead(size, content[]);", &callback));
+}
+
+TEST(CallbackParserTest, ParseLineThrottlingAnnotations) {
+  Callback callback;
+
+  std::unique_ptr<CallbackParser> parser(new CallbackParser());
+  ASSERT_TRUE(parser->ParseLine(
+      "[Coalesce=playerid, Window=50ms] forward OnShot(weaponid, playerid);", &callback));
+
+  EXPECT_EQ(1, callback.coalesce_index);
+  EXPECT_EQ(50, callback.coalesce_window);
+  EXPECT_EQ(1u, callback.sample_rate);
+
+  ASSERT_TRUE(parser->ParseLine("[Sample=1/4] forward OnUpdate(vehicleid);", &callback));
+  EXPECT_EQ(-1, callback.coalesce_index);
+  EXPECT_EQ(4u, callback.sample_rate);
+
+  EXPECT_FALSE(parser->ParseLine("[Coalesce=playerid] forward OnShot(playerid);", &callback));
+  EXPECT_FALSE(parser->ParseLine("[Window=50ms] forward OnShot(playerid);", &callback));
+  EXPECT_FALSE(parser->ParseLine(
+      "[Coalesce=vehicleid, Window=50] forward OnShot(playerid);", &callback));
+  EXPECT_FALSE(parser->ParseLine("[Sample=4] forward OnUpdate(vehicleid);", &callback));
+  EXPECT_FALSE(parser->ParseLine(
+      "[Cancelable, Sample=1/2] forward OnUpdate(vehicleid);", &callback));
+  EXPECT_FALSE(parser->ParseLine(
+      "[Sample=1/2] forward OnPlayerStateChange(playerid, newstate, oldstate);", &callback));
+}
+
 TEST(CallbackParserTest, ParseLineOneArgument) {
   Callback callback;
 
@@ -103,6 +178,9 @@ TEST(CallbackParserTest, ParseFromString) {
   ASSERT_TRUE(parser != nullptr);
 
   EXPECT_EQ(2u, parser->size());
+
+  ASSERT_TRUE(parser->Find("OnMySecondCallback"));
+  EXPECT_EQ(1u, parser->Find("OnMySecondCallback")->id);
 }
 
 TEST(CallbackParserTest, ParseFromFile) {
@@ -0,0 +1,184 @@
+// Copyright 2020 Las Venturas Playground. All rights reserved.
+// Use of this source code is governed by the MIT license, a copy of which can
+// be found in the LICENSE file.
+
+#include "plugin/deferred_event_queue.h"
+
+#include <algorithm>
+#include <string.h>
+
+#include "base/logging.h"
+#include "plugin/arguments.h"
+
+namespace plugin {
+
+DeferredEventQueue::Ring::Ring(const Callback& callback, size_t capacity)
+    : callback_(callback),
+      capacity_(capacity) {
+  DCHECK(capacity_ > 0);
+
+  columns_.resize(callback.arguments.size());
+  for (size_t index = 0; index < columns_.size(); ++index)
+    columns_[index].type = callback.arguments[index].second;
+}
+
+DeferredEventQueue::Ring::~Ring() = default;
+
+void DeferredEventQueue::Ring::CopySequences(uint32_t* destination) const {
+  for (size_t index = 0; index < size_; ++index)
+    destination[index] = sequences_[slot(index)];
+}
+
+void DeferredEventQueue::Ring::CopyCells(size_t column, int32_t* destination) const {
+  DCHECK(columns_[column].type != ARGUMENT_TYPE_STRING);
+  if (!size_)
+    return;
+
+  const std::vector<int32_t>& cells = columns_[column].cells;
+
+  // The queued events are contiguous in at most two segments of the buffer.
+  const size_t first_segment = std::min(size_, capacity_ - head_);
+
+  memcpy(destination, &cells[head_], first_segment * sizeof(int32_t));
+  if (first_segment < size_)
+    memcpy(destination + first_segment, &cells[0], (size_ - first_segment) * sizeof(int32_t));
+}
+
+const std::string& DeferredEventQueue::Ring::GetString(size_t column, size_t index) const {
+  DCHECK(columns_[column].type == ARGUMENT_TYPE_STRING);
+  DCHECK(index < size_);
+
+  return columns_[column].strings[slot(index)];
+}
+
+void DeferredEventQueue::Ring::Push(const Arguments& arguments, uint32_t sequence) {
+  // Allocate the storage lazily, so that deferred callbacks that never fire don't need memory.
+  if (sequences_.empty()) {
+    sequences_.resize(capacity_);
+    for (Column& column : columns_) {
+      if (column.type == ARGUMENT_TYPE_STRING)
+        column.strings.resize(capacity_);
+      else
+        column.cells.resize(capacity_);
+    }
+  }
+
+  const bool merge = callback_.deferred_policy == DEFERRED_POLICY_LATEST_PER_PLAYER;
+  const int32_t merge_key = merge ? arguments.GetInteger(0) : 0;
+
+  if (merge) {
+    auto slot_iter = merge_slots_.find(merge_key);
+    if (slot_iter != merge_slots_.end()) {
+      Write(slot_iter->second, arguments);
+      ++merged_;
+      return;
+    }
+  }
+
+  size_t target_slot = 0;
+  if (size_ < capacity_) {
+    target_slot = slot(size_++);
+  } else {
+    ++dropped_;
+
+    if (callback_.deferred_policy == DEFERRED_POLICY_DROP_NEWEST)
+      return;
+
+    target_slot = head_;
+    head_ = (head_ + 1) % capacity_;
+
+    if (merge)
+      merge_slots_.erase(columns_[0].cells[target_slot]);
+  }
+
+  if (merge)
+    merge_slots_[merge_key] = target_slot;
+
+  sequences_[target_slot] = sequence;
+  Write(target_slot, arguments);
+}
+
+void DeferredEventQueue::Ring::Write(size_t target_slot, const Arguments& arguments) {
+  for (size_t index = 0; index < columns_.size(); ++index) {
+    Column& column = columns_[index];
+    switch (column.type) {
+    case ARGUMENT_TYPE_INT:
+      column.cells[target_slot] = arguments.GetInteger(index);
+      break;
+    case ARGUMENT_TYPE_FLOAT:
+      {
+        const float value = arguments.GetFloat(index);
+        memcpy(&column.cells[target_slot], &value, sizeof(int32_t));
+      }
+      break;
+    case ARGUMENT_TYPE_STRING:
+      column.strings[target_slot].assign(arguments.GetString(index));
+      break;
+    case ARGUMENT_TYPE_ARRAY:
+      break;  // deferred callbacks cannot have array arguments.
+    }
+  }
+}
+
+void DeferredEventQueue::Ring::Clear() {
+  merge_slots_.clear();
+
+  head_ = 0;
+  size_ = 0;
+}
+
+DeferredEventQueue::DeferredEventQueue(size_t default_capacity)
+    : default_capacity_(default_capacity) {}
+
+DeferredEventQueue::~DeferredEventQueue() = default;
+
+void DeferredEventQueue::RegisterCallback(const Callback& callback) {
+  if (callback.id >= rings_.size())
+    rings_.resize(callback.id + 1);
+
+  const size_t capacity = callback.deferred_limit ? callback.deferred_limit : default_capacity_;
+  rings_[callback.id].reset(new Ring(callback, capacity));
+}
+
+bool DeferredEventQueue::Push(const Callback& callback, const Arguments& arguments) {
+  if (callback.id >= rings_.size() || !rings_[callback.id]) {
+    LOG(ERROR) << "Unable to queue an event for unregistered deferred callback " << callback.name;
+    return false;
+  }
+
+  Ring* ring = rings_[callback.id].get();
+
+  const size_t previous_size = ring->size();
+  ring->Push(arguments, sequence_++);
+
+  size_ += ring->size() - previous_size;
+  return true;
+}
+
+void DeferredEventQueue::Clear() {
+  for (const auto& ring : rings_) {
+    if (ring)
+      ring->Clear();
+  }
+
+  sequence_ = 0;
+  size_ = 0;
+}
+
+size_t DeferredEventQueue::dropped() const {
+  size_t dropped = 0;
+  for (const auto& ring : rings_)
+    dropped += ring ? ring->dropped() : 0;
+
+  return dropped;
+}
+
+size_t DeferredEventQueue::merged() const {
+  size_t merged = 0;
+  for (const auto& ring : rings_)
+    merged += ring ? ring->merged() : 0;
+
+  return merged;
+}
+
+}  // namespace plugin
@@ -0,0 +1,145 @@
+// Copyright 2020 Las Venturas Playground. All rights reserved.
+// Use of this source code is governed by the MIT license, a copy of which can
+// be found in the LICENSE file.
+
+#ifndef PLAYGROUND_PLUGIN_DEFERRED_EVENT_QUEUE_H_
+#define PLAYGROUND_PLUGIN_DEFERRED_EVENT_QUEUE_H_
+
+#include <stdint.h>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "base/macros.h"
+#include "plugin/callback.h"
+
+namespace plugin {
+
+class Arguments;
+
+// Queue of deferred callbacks that have been intercepted, but not yet pulled by JavaScript. Each
+// deferred callback has a fixed-capacity ring buffer in which the arguments are stored column-wise,
+// which enables them to be handed to JavaScript as typed arrays rather than as individual objects.
+//
+// Events are numbered with a sequence number that's shared between all callbacks, so that their
+// global order of arrival can be restored. The sequence restarts when the queue gets cleared.
+//
+// The capacity of a ring buffer can be configured per callback through its Limit annotation. Its
+// Policy annotation determines whether new or old events will be dropped when the ring is full, or
+// whether events for the same player will be merged. Merged events retain the position and the
+// sequence number of the queued event, but take the values of the new one.
+//
+// Integer and float arguments are stored as 32-bit cells, much like Pawn does. Array arguments are
+// not supported by deferred callbacks.
+class DeferredEventQueue {
+ public:
+  // Default number of events that can be stored for deferred callbacks without a Limit.
+  static constexpr size_t kDefaultCapacity = 4096;
+
+  // Ring buffer storing the queued events for a single deferred callback.
+  class Ring {
+   public:
+    Ring(const Callback& callback, size_t capacity);
+    ~Ring();
+
+    // Returns the callback for which this ring stores events.
+    const Callback& callback() const { return callback_; }
+
+    // Copies the sequence numbers of the queued events, oldest first, to |destination|.
+    void CopySequences(uint32_t* destination) const;
+
+    // Copies the cells of the integer or float |column|, oldest first, to |destination|.
+    void CopyCells(size_t column, int32_t* destination) const;
+
+    // Returns the string in |column| for the |index|th queued event, oldest first.
+    const std::string& GetString(size_t column, size_t index) const;
+
+    size_t capacity() const { return capacity_; }
+    size_t dropped() const { return dropped_; }
+    size_t merged() const { return merged_; }
+    size_t size() const { return size_; }
+
+   private:
+    friend class DeferredEventQueue;
+
+    struct Column {
+      CallbackArgumentType type;
+
+      // Storage for the column. Only one of these will be used, depending on the |type|.
+      std::vector<int32_t> cells;
+      std::vector<std::string> strings;
+    };
+
+    // Stores the |arguments| with the given |sequence| number, subject to the callback's policy.
+    void Push(const Arguments& arguments, uint32_t sequence);
+
+    // Writes the |arguments| to the given |target_slot| in the buffers.
+    void Write(size_t target_slot, const Arguments& arguments);
+
+    // Removes all queued events, while retaining the allocated storage.
+    void Clear();
+
+    // Returns the slot in the buffers at which the |index|th queued event is stored.
+    size_t slot(size_t index) const { return (head_ + index) % capacity_; }
+
+    Callback callback_;
+    size_t capacity_;
+
+    std::vector<uint32_t> sequences_;
+    std::vector<Column> columns_;
+
+    // Slot of the oldest queued event, and the number of events that have been queued.
+    size_t head_ = 0;
+    size_t size_ = 0;
+
+    // Map from the first argument of queued events to their slot, for merging events.
+    std::unordered_map<int32_t, size_t> merge_slots_;
+
+    // Number of events that have been dropped because the ring was full, or that were merged.
+    size_t dropped_ = 0;
+    size_t merged_ = 0;
+
+    DISALLOW_COPY_AND_ASSIGN(Ring);
+  };
+
+  explicit DeferredEventQueue(size_t default_capacity = kDefaultCapacity);
+  ~DeferredEventQueue();
+
+  // Registers |callback| as a deferred callback for which events can be queued.
+  void RegisterCallback(const Callback& callback);
+
+  // Queues an event for |callback| with the given |arguments|. Returns whether the event could be
+  // stored, which requires the |callback| to have been registered.
+  bool Push(const Callback& callback, const Arguments& arguments);
+
+  // Removes all queued events, and restarts the sequence numbering.
+  void Clear();
+
+  // Returns the rings for the registered callbacks, indexed by the callback's Id. Entries for
+  // callbacks that have not been registered will be a nullptr.
+  const std::vector<std::unique_ptr<Ring>>& rings() const { return rings_; }
+
+  // Returns the total number of events that have been dropped because their ring was full.
+  size_t dropped() const;
+
+  // Returns the total number of events that have been merged with a queued event.
+  size_t merged() const;
+
+  // Returns the number of events that are currently queued.
+  size_t size() const { return size_; }
+
+ private:
+  size_t default_capacity_;
+
+  std::vector<std::unique_ptr<Ring>> rings_;
+
+  uint32_t sequence_ = 0;
+  size_t size_ = 0;
+
+  DISALLOW_COPY_AND_ASSIGN(DeferredEventQueue);
+};
+
+}  // namespace plugin
+
+#endif  // PLAYGROUND_PLUGIN_DEFERRED_EVENT_QUEUE_H_
@@ -0,0 +1,178 @@
+// Copyright 2020 Las Venturas Playground. All rights reserved.
+// Use of this source code is governed by the MIT license, a copy of which can
+// be found in the LICENSE file.
+
+#include "plugin/deferred_event_queue.h"
+
+#include "gtest/gtest.h"
+#include "plugin/arguments.h"
+
+namespace plugin {
+namespace {
+
+Callback CreateCallback(size_t id, const std::string& name) {
+  Callback callback;
+  callback.id = id;
+  callback.name = name;
+  callback.deferred = true;
+  callback.arguments.push_back(std::make_pair("playerid", ARGUMENT_TYPE_INT));
+  callback.arguments.push_back(std::make_pair("amount", ARGUMENT_TYPE_FLOAT));
+  callback.arguments.push_back(std::make_pair("text", ARGUMENT_TYPE_STRING));
+
+  return callback;
+}
+
+void Push(DeferredEventQueue* queue, const Callback& callback, int player_id, float amount,
+          const std::string& text) {
+  Arguments arguments;
+  arguments.Reset(3);
+  arguments.SetInteger(0, player_id);
+  arguments.SetFloat(1, amount);
+  arguments.SetString(2, text);
+
+  EXPECT_TRUE(queue->Push(callback, arguments));
+}
+
+// Returns the first argument of each of the events queued for |callback| in |queue|.
+std::vector<int32_t> GetPlayerIds(const DeferredEventQueue& queue, const Callback& callback) {
+  const DeferredEventQueue::Ring& ring = *queue.rings()[callback.id];
+
+  std::vector<int32_t> player_ids(ring.size());
+  ring.CopyCells(0, player_ids.data());
+
+  return player_ids;
+}
+
+}  // namespace
+
+TEST(DeferredEventQueueTest, ColumnsAndSequences) {
+  DeferredEventQueue queue;
+
+  const Callback first = CreateCallback(1, "OnFirst");
+  const Callback second = CreateCallback(3, "OnSecond");
+
+  queue.RegisterCallback(first);
+  queue.RegisterCallback(second);
+
+  ASSERT_EQ(4u, queue.rings().size());
+  EXPECT_FALSE(queue.rings()[0]);
+  EXPECT_FALSE(queue.rings()[2]);
+
+  Push(&queue, first, 10, 1.5f, "a");
+  Push(&queue, second, 20, 2.5f, "b");
+  Push(&queue, first, 30, 3.5f, "c");
+
+  EXPECT_EQ(3u, queue.size());
+
+  const DeferredEventQueue::Ring& ring = *queue.rings()[1];
+  ASSERT_EQ(2u, ring.size());
+
+  uint32_t sequences[2];
+  ring.CopySequences(sequences);
+  EXPECT_EQ(0u, sequences[0]);
+  EXPECT_EQ(2u, sequences[1]);
+
+  int32_t player_ids[2];
+  ring.CopyCells(0, player_ids);
+  EXPECT_EQ(10, player_ids[0]);
+  EXPECT_EQ(30, player_ids[1]);
+
+  float amounts[2];
+  ring.CopyCells(1, reinterpret_cast<int32_t*>(amounts));
+  EXPECT_EQ(1.5f, amounts[0]);
+  EXPECT_EQ(3.5f, amounts[1]);
+
+  EXPECT_EQ("a", ring.GetString(2, 0));
+  EXPECT_EQ("c", ring.GetString(2, 1));
+
+  queue.Clear();
+  EXPECT_EQ(0u, queue.size());
+  EXPECT_EQ(0u, ring.size());
+
+  Arguments arguments;
+  EXPECT_FALSE(queue.Push(CreateCallback(0, "OnUnregistered"), arguments));
+}
+
+TEST(DeferredEventQueueTest, DropsOldestWhenFull) {
+  DeferredEventQueue queue(2 /* default_capacity */);
+
+  const Callback callback = CreateCallback(0, "OnCallback");
+  queue.RegisterCallback(callback);
+
+  Push(&queue, callback, 1, 0.0f, "one");
+  Push(&queue, callback, 2, 0.0f, "two");
+  Push(&queue, callback, 3, 0.0f, "three");
+
+  EXPECT_EQ(2u, queue.size());
+  EXPECT_EQ(1u, queue.dropped());
+
+  const DeferredEventQueue::Ring& ring = *queue.rings()[0];
+  ASSERT_EQ(2u, ring.size());
+
+  EXPECT_EQ(std::vector<int32_t>({ 2, 3 }), GetPlayerIds(queue, callback));
+
+  uint32_t sequences[2];
+  ring.CopySequences(sequences);
+  EXPECT_EQ(1u, sequences[0]);
+  EXPECT_EQ(2u, sequences[1]);
+
+  EXPECT_EQ("two", ring.GetString(2, 0));
+  EXPECT_EQ("three", ring.GetString(2, 1));
+}
+
+TEST(DeferredEventQueueTest, DropsNewestWhenFull) {
+  DeferredEventQueue queue;
+
+  Callback callback = CreateCallback(0, "OnCallback");
+  callback.deferred_limit = 2;
+  callback.deferred_policy = DEFERRED_POLICY_DROP_NEWEST;
+
+  queue.RegisterCallback(callback);
+  ASSERT_EQ(2u, queue.rings()[0]->capacity());
+
+  Push(&queue, callback, 1, 0.0f, "one");
+  Push(&queue, callback, 2, 0.0f, "two");
+  Push(&queue, callback, 3, 0.0f, "three");
+
+  EXPECT_EQ(2u, queue.size());
+  EXPECT_EQ(1u, queue.dropped());
+  EXPECT_EQ(std::vector<int32_t>({ 1, 2 }), GetPlayerIds(queue, callback));
+}
+
+TEST(DeferredEventQueueTest, MergesLatestPerPlayer) {
+  DeferredEventQueue queue;
+
+  Callback callback = CreateCallback(0, "OnCallback");
+  callback.deferred_limit = 2;
+  callback.deferred_policy = DEFERRED_POLICY_LATEST_PER_PLAYER;
+
+  queue.RegisterCallback(callback);
+
+  Push(&queue, callback, 1, 1.0f, "first");
+  Push(&queue, callback, 2, 2.0f, "second");
+  Push(&queue, callback, 1, 3.0f, "third");
+
+  EXPECT_EQ(2u, queue.size());
+  EXPECT_EQ(1u, queue.merged());
+  EXPECT_EQ(0u, queue.dropped());
+
+  const DeferredEventQueue::Ring& ring = *queue.rings()[0];
+  EXPECT_EQ(std::vector<int32_t>({ 1, 2 }), GetPlayerIds(queue, callback));
+  EXPECT_EQ("third", ring.GetString(2, 0));
+
+  // A third player drops the oldest event, after which player 1 is no longer merged.
+  Push(&queue, callback, 3, 4.0f, "fourth");
+  Push(&queue, callback, 1, 5.0f, "fifth");
+
+  EXPECT_EQ(2u, queue.size());
+  EXPECT_EQ(2u, queue.dropped());
+  EXPECT_EQ(std::vector<int32_t>({ 3, 1 }), GetPlayerIds(queue, callback));
+
+  queue.Clear();
+
+  Push(&queue, callback, 3, 6.0f, "sixth");
+  EXPECT_EQ(1u, queue.size());
+  EXPECT_EQ(1u, queue.merged());
+}
+
+}  // namespace plugin
@@ -0,0 +1,119 @@
+// Copyright 2020 Las Venturas Playground. All rights reserved.
+// Use of this source code is governed by the MIT license, a copy of which can
+// be found in the LICENSE file.
+
+#include "plugin/deferred_native_queue.h"
+
+#include <string.h>
+
+#include "base/logging.h"
+
+namespace plugin {
+
+DeferredNativeQueue::DeferredNativeQueue() = default;
+
+DeferredNativeQueue::~DeferredNativeQueue() = default;
+
+bool DeferredNativeQueue::Enqueue(int native_id, const char* format, void** arguments,
+                                  bool supersede) {
+  const size_t argument_count = format ? strlen(format) : 0;
+  if (argument_count > kMaxArguments) {
+    LOG(WARNING) << "Unable to defer a native call with " << argument_count << " arguments.";
+    return false;
+  }
+
+  for (size_t index = 0; index < argument_count; ++index) {
+    if (format[index] != 'i' && format[index] != 'f' && format[index] != 's') {
+      LOG(WARNING) << "Unable to defer a native call with a '" << format[index] << "' argument.";
+      return false;
+    }
+  }
+
+  Entry entry;
+  entry.native_id = native_id;
+  entry.format_offset = Append(format ? format : "", argument_count + 1);
+  entry.data_offset = static_cast<uint32_t>(data_.size());
+  entry.superseded = false;
+
+  for (size_t index = 0; index < argument_count; ++index) {
+    if (format[index] == 's') {
+      const char* string = reinterpret_cast<const char*>(arguments[index]);
+      Append(string, strlen(string) + 1);
+    } else {
+      Append(arguments[index], sizeof(int32_t));
+    }
+  }
+
+  if (supersede) {
+    // The target of the call is identified by the native and its leading integer arguments.
+    std::string key(reinterpret_cast<const char*>(&native_id), sizeof(native_id));
+    for (size_t index = 0; index < argument_count && format[index] == 'i'; ++index)
+      key.append(reinterpret_cast<const char*>(arguments[index]), sizeof(int32_t));
+
+    auto iter = superseding_entries_.find(key);
+    if (iter != superseding_entries_.end()) {
+      entries_[iter->second].superseded = true;
+      iter->second = entries_.size();
+
+      ++superseded_entries_;
+    } else {
+      superseding_entries_.emplace(std::move(key), entries_.size());
+    }
+  }
+
+  entries_.push_back(entry);
+  return true;
+}
+
+size_t DeferredNativeQueue::Flush(const Invoker& invoker) {
+  if (entries_.empty())
+    return 0;
+
+  // Move the queued calls aside, as executing natives may cause new calls to be queued.
+  flushing_entries_.swap(entries_);
+  flushing_data_.swap(data_);
+
+  superseding_entries_.clear();
+  superseded_entries_ = 0;
+
+  void* arguments[kMaxArguments];
+  size_t executed = 0;
+
+  for (const Entry& entry : flushing_entries_) {
+    if (entry.superseded)
+      continue;
+
+    const char* format = reinterpret_cast<const char*>(&flushing_data_[entry.format_offset]);
+    uint8_t* data = &flushing_data_[entry.data_offset];
+
+    for (size_t index = 0; format[index]; ++index) {
+      arguments[index] = data;
+
+      size_t size = sizeof(int32_t);
+      if (format[index] == 's')
+        size = strlen(reinterpret_cast<const char*>(data)) + 1;
+
+      data += (size + 3) & ~static_cast<size_t>(3);
+    }
+
+    invoker(entry.native_id, format, arguments);
+    ++executed;
+  }
+
+  flushing_entries_.clear();
+  flushing_data_.clear();
+
+  return executed;
+}
+
+uint32_t DeferredNativeQueue::Append(const void* data, size_t size) {
+  const size_t offset = data_.size();
+  const size_t padded_size = (size + 3) & ~static_cast<size_t>(3);
+
+  data_.resize(offset + padded_size, 0);
+  memcpy(&data_[offset], data, size);
+
+  return static_cast<uint32_t>(offset);
+}
+
+}  // namespace plugin
@@ -0,0 +1,82 @@
+// Copyright 2020 Las Venturas Playground. All rights reserved.
+// Use of this source code is governed by the MIT license, a copy of which can
+// be found in the LICENSE file.
+
+#ifndef PLAYGROUND_PLUGIN_DEFERRED_NATIVE_QUEUE_H_
+#define PLAYGROUND_PLUGIN_DEFERRED_NATIVE_QUEUE_H_
+
+#include <stdint.h>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "base/macros.h"
+
+namespace plugin {
+
+// Queue of native function calls whose results are not of interest to the caller, for example
+// updating a text draw or sending a message to a player. The calls are copied in to a compact,
+// per-frame command buffer, and will be executed in order when the queue gets flushed.
+//
+// Only integer, float and string parameters ([ifs]) are supported, as there is no way to return
+// the values of reference parameters to the caller.
+//
+// Calls may be marked as superseding. Such calls replace an earlier superseding call to the same
+// native on the same target, which is identified by the leading integer arguments of the call. For
+// example, only the last of multiple SetPlayerPos(playerid, ...) calls for a given player will be
+// executed, at the position in the queue of that last call.
+class DeferredNativeQueue {
+ public:
+  // Function through which the queued natives will be invoked.
+  using Invoker = std::function<int(int native_id, const char* format, void** arguments)>;
+
+  // Maximum number of arguments that can be passed to a deferred native.
+  static constexpr size_t kMaxArguments = 24;
+
+  DeferredNativeQueue();
+  ~DeferredNativeQueue();
+
+  // Queues a call to |native_id| with |arguments| structured like |format|. All arguments will be
+  // copied. Returns whether the call could be queued.
+  bool Enqueue(int native_id, const char* format, void** arguments, bool supersede);
+
+  // Executes all queued calls through |invoker| in the order in which they were queued. Calls that
+  // are queued while flushing will be executed by the next flush. Returns the number of calls.
+  size_t Flush(const Invoker& invoker);
+
+  // Returns the number of calls that are currently waiting in the queue.
+  size_t size() const { return entries_.size() - superseded_entries_; }
+
+ private:
+  struct Entry {
+    int native_id;
+
+    // Offsets of the format and of the first argument in the |data_| buffer.
+    uint32_t format_offset;
+    uint32_t data_offset;
+
+    bool superseded;
+  };
+
+  // Appends |size| bytes from |data| to the |data_| buffer, padded to a multiple of four bytes so
+  // that integers and floats remain aligned. Returns the offset at which the data was written.
+  uint32_t Append(const void* data, size_t size);
+
+  std::vector<Entry> entries_;
+  std::vector<uint8_t> data_;
+
+  // Buffers that are being executed by Flush(). Kept around to retain their capacity.
+  std::vector<Entry> flushing_entries_;
+  std::vector<uint8_t> flushing_data_;
+
+  // Map from the native and target of a superseding call to its index in |entries_|.
+  std::unordered_map<std::string, size_t> superseding_entries_;
+  size_t superseded_entries_ = 0;
+
+  DISALLOW_COPY_AND_ASSIGN(DeferredNativeQueue);
+};
+
+}  // namespace plugin
+
+#endif  // PLAYGROUND_PLUGIN_DEFERRED_NATIVE_QUEUE_H_
@@ -0,0 +1,101 @@
+// Copyright 2020 Las Venturas Playground. All rights reserved.
+// Use of this source code is governed by the MIT license, a copy of which can
+// be found in the LICENSE file.
+
+#include "plugin/deferred_native_queue.h"
+
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace plugin {
+
+TEST(DeferredNativeQueueTest, FlushInOrder) {
+  DeferredNativeQueue queue;
+
+  int player_id = 12;
+  int color = 0xFF0000AA;
+  char message[] = "Hello, world!";
+  void* first_arguments[] = { &player_id, &color, message };
+
+  float health = 50.0f;
+  void* second_arguments[] = { &player_id, &health };
+
+  ASSERT_TRUE(queue.Enqueue(1, "iis", first_arguments, false));
+  ASSERT_TRUE(queue.Enqueue(2, "if", second_arguments, false));
+  ASSERT_TRUE(queue.Enqueue(3, nullptr, nullptr, false));
+
+  // Changing the arguments after queueing the call must not affect the queued call.
+  message[0] = 'J';
+  player_id = 0;
+
+  EXPECT_EQ(3u, queue.size());
+
+  std::vector<std::string> calls;
+  EXPECT_EQ(3u, queue.Flush([&](int native_id, const char* format, void** arguments) {
+    std::string call = std::to_string(native_id) + ":" + format;
+    if (native_id == 1) {
+      call += ":" + std::to_string(*reinterpret_cast<int*>(arguments[0]));
+      call += ":" + std::string(reinterpret_cast<char*>(arguments[2]));
+    } else if (native_id == 2) {
+      call += ":" + std::to_string(*reinterpret_cast<float*>(arguments[1]));
+    }
+
+    calls.push_back(call);
+    return 0;
+  }));
+
+  ASSERT_EQ(3u, calls.size());
+  EXPECT_EQ("1:iis:12:Hello, world!", calls[0]);
+  EXPECT_EQ("2:if:50.000000", calls[1]);
+  EXPECT_EQ("3:", calls[2]);
+
+  EXPECT_EQ(0u, queue.size());
+  EXPECT_EQ(0u, queue.Flush([](int, const char*, void**) { return 0; }));
+}
+
+TEST(DeferredNativeQueueTest, SupersedeCalls) {
+  DeferredNativeQueue queue;
+
+  int player_id = 5;
+  float x = 1.0f;
+  void* arguments[] = { &player_id, &x };
+
+  ASSERT_TRUE(queue.Enqueue(7, "if", arguments, true));
+
+  player_id = 6;
+  ASSERT_TRUE(queue.Enqueue(7, "if", arguments, true));
+
+  player_id = 5;
+  x = 2.0f;
+  ASSERT_TRUE(queue.Enqueue(7, "if", arguments, true));
+  ASSERT_TRUE(queue.Enqueue(7, "if", arguments, false));
+
+  EXPECT_EQ(3u, queue.size());
+
+  std::vector<std::pair<int, float>> calls;
+  EXPECT_EQ(3u, queue.Flush([&](int native_id, const char* format, void** arguments) {
+    calls.emplace_back(*reinterpret_cast<int*>(arguments[0]),
+                       *reinterpret_cast<float*>(arguments[1]));
+    return 0;
+  }));
+
+  ASSERT_EQ(3u, calls.size());
+  EXPECT_EQ(std::make_pair(6, 1.0f), calls[0]);
+  EXPECT_EQ(std::make_pair(5, 2.0f), calls[1]);
+  EXPECT_EQ(std::make_pair(5, 2.0f), calls[2]);
+}
+
+TEST(DeferredNativeQueueTest, RejectReferences) {
+  DeferredNativeQueue queue;
+
+  int player_id = 0;
+  float x = 0;
+  void* arguments[] = { &player_id, &x };
+
+  EXPECT_FALSE(queue.Enqueue(1, "ir", arguments, false));
+  EXPECT_EQ(0u, queue.size());
+}
+
+}  // namespace plugin
@@ -8,6 +8,7 @@
 #include <string.h>
 
 #include "base/logging.h"
+#include "plugin/string_marshalling.h"
 
 namespace plugin {
 
@@ -18,85 +19,98 @@ const size_t kHeapCellSize = 4096;
 
 }  // namespace
 
-FakeAMX::FakeAMX() {
-  amx_heap_.reset(static_cast<unsigned char*>(calloc(1, kHeapCellSize * sizeof(cell))));
-
+FakeAMX::FakeAMX()
+    : amx_heap_(kHeapCellSize, 0) {
   memset((void*) &amx_, 0, sizeof(amx_));
   amx_.base = reinterpret_cast<unsigned char*>(&amx_header_);
   amx_.callback = amx_Callback;
-  amx_.data = amx_heap_.get();
   amx_.flags = AMX_FLAG_NTVREG | AMX_FLAG_RELOC;
-  amx_.stk = amx_.stp = kHeapCellSize * sizeof(cell);
 
   memset((void*) &amx_header_, 0, sizeof(amx_header_));
   amx_header_.amx_version = MIN_AMX_VERSION;
-  amx_header_.dat =
-      reinterpret_cast<cell>(amx_heap_.get()) - reinterpret_cast<cell>(&amx_header_);
   amx_header_.defsize = sizeof(AMX_FUNCSTUB);
   amx_header_.file_version = CUR_FILE_VERSION;
   amx_header_.magic = AMX_MAGIC;
-}
-
-FakeAMX::~FakeAMX() {}
 
-FakeAMX::ScopedStackModifier FakeAMX::GetScopedStackModifier() {
-  return ScopedStackModifier(this);
+  UpdateHeapPointers();
 }
 
-FakeAMX::ScopedStackModifier::ScopedStackModifier(FakeAMX* fake_amx)
-  : fake_amx_(fake_amx),
-    stored_hea_(fake_amx_->amx_.hea) {}
-
-FakeAMX::ScopedStackModifier::~ScopedStackModifier() {
-  fake_amx_->amx_.hea = stored_hea_;
-}
+FakeAMX::~FakeAMX() {}
 
-cell FakeAMX::ScopedStackModifier::PushCell(cell value) {
-  cell address = Allocate(1);
+cell FakeAMX::PushCell(cell value) {
+  const cell address = Allocate(1);
+  if (address == kInvalidAddress)
+    return kInvalidAddress;
 
-  reinterpret_cast<cell*>(fake_amx_->amx_heap_.get())[address / sizeof(cell)] = value;
+  *GetCell(address) = value;
   return address;
 }
 
-cell FakeAMX::ScopedStackModifier::PushString(char* string) {
+cell FakeAMX::PushString(const char* string) {
   DCHECK(string);
 
-  size_t length = strlen(string);
-  cell address = Allocate(length + 1);
-
-  amx_SetString(reinterpret_cast<cell*>(fake_amx_->amx_heap_.get()) + address / sizeof(cell),
-                string, 0, 0, length + 1);
+  const size_t length = strlen(string);
+  const cell address = Allocate(length + 1);
+  if (address == kInvalidAddress)
+    return kInvalidAddress;
 
+  WidenString(string, length, GetCell(address));
   return address;
 }
 
-cell FakeAMX::ScopedStackModifier::PushArray(cell* data, size_t size) {
+cell FakeAMX::PushArray(const cell* data, size_t size) {
   DCHECK(data);
 
-  cell address = Allocate(size);
+  const cell address = Allocate(size);
+  if (address == kInvalidAddress)
+    return kInvalidAddress;
 
-  cell* dest = reinterpret_cast<cell*>(fake_amx_->amx_heap_.get()) + address / sizeof(cell);
-  memcpy(dest, data, size * sizeof(cell));
- 
+  memcpy(GetCell(address), data, size * sizeof(cell));
   return address;
 }
 
-void FakeAMX::ScopedStackModifier::ReadCell(cell address, cell* dest) {
-  *dest = reinterpret_cast<cell*>(fake_amx_->amx_heap_.get())[address / sizeof(cell)];
+void FakeAMX::ReadCell(cell address, cell* dest) const {
+  *dest = *GetCell(address);
 }
 
-void FakeAMX::ScopedStackModifier::ReadArray(cell address, char* data, size_t size) {
-  const cell* source = reinterpret_cast<cell*>(fake_amx_->amx_heap_.get()) + address / sizeof(cell);
-  amx_GetString(data, source, 0, size);
+void FakeAMX::ReadArray(cell address, char* data, size_t size) const {
+  NarrowString(GetCell(address), data, size);
 }
 
-cell FakeAMX::ScopedStackModifier::Allocate(size_t size) {
+cell FakeAMX::Allocate(size_t size) {
   DCHECK(size > 0);
 
-  cell old_hea = fake_amx_->amx_.hea;
-  fake_amx_->amx_.hea += size * sizeof(cell);
+  const cell address = amx_.hea;
+  const size_t required_size = address / sizeof(cell) + size;
+
+  if (required_size > amx_heap_.size()) {
+    if (heap_reset_depth_ > 1) {
+      LOG(WARNING) << "Unable to grow the heap of the fake AMX during a nested native call.";
+      return kInvalidAddress;
+    }
 
-  return old_hea;
+    GrowHeap(required_size);
+  }
+
+  amx_.hea += size * sizeof(cell);
+  return address;
+}
+
+void FakeAMX::GrowHeap(size_t size) {
+  size_t new_size = amx_heap_.size();
+  while (new_size < size)
+    new_size *= 2;
+
+  amx_heap_.resize(new_size, 0);
+  UpdateHeapPointers();
+}
+
+void FakeAMX::UpdateHeapPointers() {
+  amx_.data = reinterpret_cast<unsigned char*>(amx_heap_.data());
+  amx_.stk = amx_.stp = amx_heap_.size() * sizeof(cell);
+
+  amx_header_.dat =
+      reinterpret_cast<cell>(amx_heap_.data()) - reinterpret_cast<cell>(&amx_header_);
 }
 
 }  // namespace plugin
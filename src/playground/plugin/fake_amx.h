@@ -5,53 +5,94 @@
 #ifndef PLAYGROUND_PLUGIN_FAKE_AMX_H_
 #define PLAYGROUND_PLUGIN_FAKE_AMX_H_
 
-#include <memory>
+#include <vector>
 
+#include "base/macros.h"
 #include "plugin/sdk/amx.h"
 
 namespace plugin {
 
 // The FakeAMX class represents a working, but fake scripting environment for a Pawn runtime, which
 // means that we don't have to rely on a live gamemode or filterscript for interaction.
+//
+// The heap of the fake AMX is a bump arena: values pushed to it are appended, and will only be
+// released when the ScopedHeapReset that was created before pushing them goes out of scope. The
+// arena grows when necessary, and retains its capacity for subsequent invocations.
+//
+// Natives may call back in to JavaScript, which may invoke another native while the outer one is
+// holding physical addresses in to the heap. Growing would move the heap, so allocations that do
+// not fit in the existing heap fail when scopes are nested.
 class FakeAMX {
  public:
+  // Address returned when a value could not be pushed to the heap.
+  static constexpr cell kInvalidAddress = -1;
+
   FakeAMX();
   ~FakeAMX();
 
   // Returns a pointer to the local initialized AMX instance.
   AMX* amx() { return &amx_; }
 
-  // All stack operations done on the Fake AMX will be scoped, to make sure that we restore the fake
-  // runtime to a clean state after every invocation.
-  class ScopedStackModifier {
-    public:
-    explicit ScopedStackModifier(FakeAMX* fake_amx);
-    ~ScopedStackModifier();
-
-    cell PushCell(cell value);
-    cell PushString(char* string);
-    cell PushArray(cell* data, size_t size);
-
-    void ReadCell(cell address, cell* dest);
-    void ReadArray(cell address, char* data, size_t size);
+  // All heap operations done on the Fake AMX will be scoped, to make sure that we restore the fake
+  // runtime to a clean state after every invocation. Restoring the heap only resets its top.
+  class ScopedHeapReset {
+   public:
+    explicit ScopedHeapReset(FakeAMX* fake_amx)
+        : fake_amx_(fake_amx),
+          stored_hea_(fake_amx->amx_.hea) {
+      ++fake_amx_->heap_reset_depth_;
+    }
+
+    ~ScopedHeapReset() {
+      fake_amx_->amx_.hea = stored_hea_;
+      --fake_amx_->heap_reset_depth_;
+    }
 
    private:
-    cell Allocate(size_t size);
-
     FakeAMX* fake_amx_;
-
     cell stored_hea_;
+
+    DISALLOW_COPY_AND_ASSIGN(ScopedHeapReset);
   };
 
-  ScopedStackModifier GetScopedStackModifier();
+  // Pushes the |value|, the zero-terminated |string| or the |size| cells in |data| to the heap,
+  // and returns the address at which it has been stored, or kInvalidAddress on failure.
+  cell PushCell(cell value);
+  cell PushString(const char* string);
+  cell PushArray(const cell* data, size_t size);
+
+  // Reads the cell at |address| in to |dest|, or the string of at most |size| bytes at |address|
+  // in to |data|.
+  void ReadCell(cell address, cell* dest) const;
+  void ReadArray(cell address, char* data, size_t size) const;
 
  private:
+  // Allocates |size| cells on the heap, and returns the address of the first cell. Addresses in the
+  // heap remain valid when it has to grow, as they are relative to its start. Returns
+  // kInvalidAddress when the heap would have to grow while ScopedHeapResets are nested.
+  cell Allocate(size_t size);
+
+  // Returns a pointer to the cell at |address| in the heap. Only valid until the next allocation.
+  cell* GetCell(cell address) { return &amx_heap_[address / sizeof(cell)]; }
+  const cell* GetCell(cell address) const { return &amx_heap_[address / sizeof(cell)]; }
+
+  // Grows the heap so that it's able to hold at least |size| cells.
+  void GrowHeap(size_t size);
+
+  // Points the AMX instance and its header to the current heap.
+  void UpdateHeapPointers();
+
   AMX amx_;
   AMX_HEADER amx_header_;
 
-  std::unique_ptr<unsigned char> amx_heap_;
+  std::vector<cell> amx_heap_;
+
+  // Number of ScopedHeapReset instances that are currently alive.
+  size_t heap_reset_depth_ = 0;
+
+  DISALLOW_COPY_AND_ASSIGN(FakeAMX);
 };
 
 }  // namespace plugin
 
-#endif  // PLAYGROUND_PLUGIN_FAKE_AMX_H_
\ No newline at end of file
+#endif  // PLAYGROUND_PLUGIN_FAKE_AMX_H_
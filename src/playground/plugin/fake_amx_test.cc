@@ -0,0 +1,108 @@
+// Copyright 2020 Las Venturas Playground. All rights reserved.
+// Use of this source code is governed by the MIT license, a copy of which can
+// be found in the LICENSE file.
+
+#include "plugin/fake_amx.h"
+
+#include <string.h>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace plugin {
+
+namespace {
+
+// Returns a pointer to the cell at |address| in the heap of the |fake_amx|.
+const cell* GetHeapCell(FakeAMX* fake_amx, cell address) {
+  return reinterpret_cast<const cell*>(fake_amx->amx()->data + address);
+}
+
+}  // namespace
+
+TEST(FakeAMXTest, HeapArena) {
+  FakeAMX fake_amx;
+
+  const cell initial_hea = fake_amx.amx()->hea;
+  {
+    FakeAMX::ScopedHeapReset heap_reset(&fake_amx);
+
+    const cell value_address = fake_amx.PushCell(42);
+    const cell string_address = fake_amx.PushString("abc");
+
+    const cell array[] = { 1, 2, 3, 4 };
+    const cell array_address = fake_amx.PushArray(array, 4);
+
+    EXPECT_EQ(initial_hea, value_address);
+    EXPECT_EQ(value_address + static_cast<cell>(sizeof(cell)), string_address);
+    EXPECT_EQ(string_address + static_cast<cell>(4 * sizeof(cell)), array_address);
+
+    // Allocations beyond the initial capacity grow the heap, and must not affect earlier values.
+    std::vector<cell> large_array(10000, 7);
+    const cell large_address = fake_amx.PushArray(large_array.data(), large_array.size());
+
+    EXPECT_EQ(42, *GetHeapCell(&fake_amx, value_address));
+    EXPECT_EQ('a', GetHeapCell(&fake_amx, string_address)[0]);
+    EXPECT_EQ(0, GetHeapCell(&fake_amx, string_address)[3]);
+    EXPECT_EQ(4, GetHeapCell(&fake_amx, array_address)[3]);
+    EXPECT_EQ(7, GetHeapCell(&fake_amx, large_address)[9999]);
+
+    cell value = 0;
+    fake_amx.ReadCell(value_address, &value);
+    EXPECT_EQ(42, value);
+
+    char string[8];
+    fake_amx.ReadArray(string_address, string, sizeof(string));
+    EXPECT_STREQ("abc", string);
+  }
+
+  EXPECT_EQ(initial_hea, fake_amx.amx()->hea);
+}
+
+TEST(FakeAMXTest, PushStringWidening) {
+  FakeAMX fake_amx;
+  FakeAMX::ScopedHeapReset heap_reset(&fake_amx);
+
+  // Cover lengths around the vector width, as well as characters that have to be sign extended.
+  std::string text;
+  for (size_t length = 0; length < 40; ++length) {
+    const cell address = fake_amx.PushString(text.c_str());
+    const cell* cells = GetHeapCell(&fake_amx, address);
+
+    for (size_t index = 0; index < length; ++index)
+      ASSERT_EQ(static_cast<cell>(static_cast<signed char>(text[index])), cells[index]);
+
+    EXPECT_EQ(0, cells[length]);
+
+    text.push_back(static_cast<char>(length % 2 ? 'a' + length : 0x80 + length));
+  }
+}
+
+TEST(FakeAMXTest, NestedHeapDoesNotGrow) {
+  FakeAMX fake_amx;
+  FakeAMX::ScopedHeapReset outer_heap_reset(&fake_amx);
+
+  const cell address = fake_amx.PushCell(42);
+  const unsigned char* data = fake_amx.amx()->data;
+
+  std::vector<cell> large_array(10000, 7);
+  {
+    FakeAMX::ScopedHeapReset inner_heap_reset(&fake_amx);
+
+    // The heap must not move while the outer scope may hold physical addresses in to it.
+    EXPECT_EQ(FakeAMX::kInvalidAddress,
+              fake_amx.PushArray(large_array.data(), large_array.size()));
+    EXPECT_EQ(FakeAMX::kInvalidAddress, fake_amx.PushString(std::string(20000, 's').c_str()));
+
+    EXPECT_NE(FakeAMX::kInvalidAddress, fake_amx.PushCell(7));
+    EXPECT_EQ(data, fake_amx.amx()->data);
+  }
+
+  EXPECT_EQ(42, *GetHeapCell(&fake_amx, address));
+
+  // Once no longer nested, the heap may grow again.
+  EXPECT_NE(FakeAMX::kInvalidAddress, fake_amx.PushArray(large_array.data(), large_array.size()));
+}
+
+}  // namespace plugin
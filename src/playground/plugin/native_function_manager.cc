@@ -119,78 +119,125 @@ int NativeFunctionManager::OnRegister(AMX* amx, const AMX_NATIVE_INFO* nativelis
       // the functions that are being registered in the amx_Register() call. This means that the first
       // function registered for a given name will be used, rather than having later registrations
       // override previous ones. Simply drop out if a double-registration is observed.
-      if (!FunctionExists(native_name))
-        native_functions_[native_name] = static_cast<NativeFn*>(nativelist[index].func);
+      if (FunctionExists(native_name))
+        continue;
+
+      const int native_id = static_cast<int>(native_functions_.size());
+
+      native_ids_[native_name] = native_id;
+      native_functions_.push_back({
+          native_name,
+          static_cast<NativeFn*>(nativelist[index].func),
+          GetArraySizeOffsetForFunctionName(native_name),
+          native_name == "CreateDynamicPolygonEx" });
+
+      if (registration_observer_)
+        registration_observer_(native_name, native_id);
     }
   }
 
+  if (!hook_)
+    return AMX_ERR_NONE;  // testing
+
   // Trampoline back to the original amx_Register function that we intercepted.
   return ((amx_Register_t) hook_->GetTrampoline())(amx, nativelist, number);
 }
 
 bool NativeFunctionManager::FunctionExists(const std::string& function_name) const {
-  return native_functions_.find(function_name) != native_functions_.end();
+  return native_ids_.find(function_name) != native_ids_.end();
+}
+
+int NativeFunctionManager::GetNativeId(const std::string& function_name) const {
+  auto id_iter = native_ids_.find(function_name);
+  if (id_iter == native_ids_.end())
+    return kInvalidNativeId;
+
+  return id_iter->second;
+}
+
+size_t NativeFunctionManager::GetArraySizeOffset(int native_id, size_t parameter_index) const {
+  if (!IsValidNativeId(native_id))
+    return 1;
+
+  const NativeFunction& native = native_functions_[native_id];
+  if (native.is_create_dynamic_polygon_ex)
+    return parameter_index == 0 /* points */ ? 3 : 4;
+
+  return native.array_size_offset;
 }
 
-int NativeFunctionManager::CallFunction(const std::string& function_name,
-                                        const char* format, void** arguments) {
-  auto function_iter = native_functions_.find(function_name);
-  if (function_iter == native_functions_.end()) {
-    LOG(WARNING) << "Attempting to invoke unknown Pawn native " << function_name << ". Ignoring.";
+int NativeFunctionManager::CallFunction(int native_id, const char* format, void** arguments,
+                                        bool* success) {
+  if (success)
+    *success = false;
+
+  if (!IsValidNativeId(native_id)) {
+    LOG(WARNING) << "Attempting to invoke unknown Pawn native with Id " << native_id << ". Ignoring.";
     return -1;
   }
 
+  const NativeFunction& native = native_functions_[native_id];
+
   AMX* amx = fake_amx_->amx();
 
+  // Fixed-size parameter frame on the stack, as natives may re-enter this method while invoked.
+  // The first entry contains the size of the parameters, in bytes, as Pawn requires.
+  int32_t params[kMaxParameters + 1];
+
   size_t param_count = format ? strlen(format) : 0;
+  if (param_count > kMaxParameters) {
+    LOG(WARNING) << "Cannot invoke " << native.name << ": too many parameters (" << param_count << ").";
+    return -1;
+  }
 
-  params_.resize(param_count + 1);
-  params_[0] = param_count * sizeof(cell);
+  params[0] = param_count * sizeof(cell);
 
   // Early-return if there are no arguments required for this native invication.
-  if (!param_count)
-    return function_iter->second(amx, params_.data());
+  if (!param_count) {
+    if (success)
+      *success = true;
+
+    return native.function(amx, params);
+  }
 
-  bool isCreateDynamicPolygonEx = function_name == "CreateDynamicPolygonEx";
-  size_t arraySizeParamOffset = GetArraySizeOffsetForFunctionName(function_name);
+  size_t arraySizeParamOffset = native.array_size_offset;
 
-  auto amx_stack = fake_amx_->GetScopedStackModifier();
+  FakeAMX::ScopedHeapReset heap_reset(fake_amx_.get());
   DCHECK(arguments);
 
-  // Process the existing parameters, either store them in |params_| or push them on the stack.
+  // Process the existing parameters, either store them in |params| or push them on the heap.
+  bool push_failed = false;
   for (size_t i = 0; i < param_count; ++i) {
     switch (format[i]) {
     case 'i':
-      params_[i + 1] = *reinterpret_cast<cell*>(arguments[i]);
+      params[i + 1] = *reinterpret_cast<cell*>(arguments[i]);
       break;
     case 'f':
-      params_[i + 1] = amx_ftoc(*reinterpret_cast<float*>(arguments[i]));
+      params[i + 1] = amx_ftoc(*reinterpret_cast<float*>(arguments[i]));
       break;
     case 'r':
-      params_[i + 1] = amx_stack.PushCell(*reinterpret_cast<cell*>(arguments[i]));
+      params[i + 1] = fake_amx_->PushCell(*reinterpret_cast<cell*>(arguments[i]));
+      push_failed |= params[i + 1] == FakeAMX::kInvalidAddress;
       break;
     case 's':
-      params_[i + 1] = amx_stack.PushString(reinterpret_cast<char*>(arguments[i]));
+      params[i + 1] = fake_amx_->PushString(reinterpret_cast<char*>(arguments[i]));
+      push_failed |= params[i + 1] == FakeAMX::kInvalidAddress;
       break;
     case 'a':
-      if (isCreateDynamicPolygonEx) {
-        if (i == 0 /* points */)
-          arraySizeParamOffset = 3;
-        else
-          arraySizeParamOffset = 4;
-      }
+      arraySizeParamOffset = GetArraySizeOffset(native_id, i);
 
       if (format[i + arraySizeParamOffset] != 'i') {
-        LOG(WARNING) << "Cannot invoke " << function_name << ": 'a' parameter must be followed by a 'i'.";
+        LOG(WARNING) << "Cannot invoke " << native.name << ": 'a' parameter must be followed by a 'i'.";
         return -1;
       }
 
       {
         int32_t size = *reinterpret_cast<int32_t*>(arguments[i + arraySizeParamOffset]);
 
-        params_[i + 1] = amx_stack.PushArray(reinterpret_cast<cell*>(arguments[i]), size);
+        params[i + 1] = fake_amx_->PushArray(reinterpret_cast<cell*>(arguments[i]), size);
+        push_failed |= params[i + 1] == FakeAMX::kInvalidAddress;
         if (arraySizeParamOffset == 1)
-          params_[i + 1 + arraySizeParamOffset] = size;
+          params[i + 1 + arraySizeParamOffset] = size;
       }
 
       if (arraySizeParamOffset == 1)
@@ -200,20 +247,28 @@ int NativeFunctionManager::CallFunction(const std::string& function_name,
     }
   }
 
-  const int return_value = function_iter->second(amx, params_.data());
+  if (push_failed) {
+    LOG(WARNING) << "Cannot invoke " << native.name << ": unable to push its arguments.";
+    return -1;
+  }
+
+  if (success)
+    *success = true;
+
+  const int return_value = native.function(amx, params);
 
   // Read back the values which may have been modified by the SA-MP server.
   for (size_t i = 0; i < param_count; ++i) {
     switch (format[i]) {
     case 'r':
-      amx_stack.ReadCell(params_[i + 1], reinterpret_cast<cell*>(arguments[i]));
+      fake_amx_->ReadCell(params[i + 1], reinterpret_cast<cell*>(arguments[i]));
       break;
     case 'a':
       {
         char* data = reinterpret_cast<char*>(arguments[i]);
         int32_t size = *reinterpret_cast<int32_t*>(arguments[i + arraySizeParamOffset]);
 
-        amx_stack.ReadArray(params_[i + 1], data, size);
+        fake_amx_->ReadArray(params[i + 1], data, size);
       }
       break;
     }
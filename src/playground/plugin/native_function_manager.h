@@ -7,6 +7,7 @@
 
 #include <stdarg.h>
 #include <stdint.h>
+#include <functional>
 #include <memory>
 #include <string>
 #include <unordered_map>
@@ -26,6 +27,9 @@ class FakeAMX;
 // functions without needing an actual gamemode.
 class NativeFunctionManager {
  public:
+  // Called when a native function named |function_name| has been assigned the |native_id|.
+  using RegistrationObserver = std::function<void(const std::string& function_name, int native_id)>;
+
   NativeFunctionManager();
   ~NativeFunctionManager();
 
@@ -36,11 +40,34 @@ class NativeFunctionManager {
   // server directly. Relies on the fact that plugins get initialized before the gamemodes.
   int OnRegister(AMX* amx, const AMX_NATIVE_INFO* nativelist, int number);
 
+  // Sets the |observer| to be invoked when a native function has been registered.
+  void set_registration_observer(RegistrationObserver observer) {
+    registration_observer_ = std::move(observer);
+  }
+
+  // Value returned by GetNativeId() when the native function could not be found.
+  static constexpr int kInvalidNativeId = -1;
+
   // Returns whether a native named |function_name| exists in the Pawn runtime.
   bool FunctionExists(const std::string& function_name) const;
 
-  // Calls |function_name| according to |format|, using |arguments| to fill in the |format|. Any
-  // number of arguments are supported, and reference types will be stored back in the pointer.
+  // Returns the Id of the native named |function_name|, or kInvalidNativeId when it does not
+  // exist. Ids are assigned densely when natives get registered, and remain valid for the lifetime
+  // of the manager. Callers are expected to resolve the Id once, and then use it for invocations.
+  int GetNativeId(const std::string& function_name) const;
+
+  // Returns whether |native_id| identifies a native that has been registered.
+  bool IsValidNativeId(int native_id) const {
+    return native_id >= 0 && native_id < static_cast<int>(native_functions_.size());
+  }
+
+  // Returns the offset between the array parameter at |parameter_index| of the native identified
+  // by |native_id| and the parameter that contains its size. This is 1 for most natives.
+  size_t GetArraySizeOffset(int native_id, size_t parameter_index) const;
+
+  // Calls the native identified by |native_id| according to |format|, using |arguments| to fill in
+  // the |format|. Any number of arguments are supported, and reference types will be stored back in
+  // the pointer.
   //
   // The following parameter formats for |format| are supported, with the accompanying type that
   // is expected to be available in |arguments|:
@@ -51,18 +78,40 @@ class NativeFunctionManager {
   //   s (char*)     - zero-terminated string
   //   a (char*)     - array (must be followed by a '+' argument w/ the int32 size)
   //
-  // Parameters of other types will result in a warning being thrown, and '-1' being returned.
-  int CallFunction(const std::string& function_name, const char* format, void** arguments);
+  // Parameters of other types will result in a warning being thrown, and '-1' being returned. The
+  // same applies when more than kMaxParameters parameters are given, or when the arguments cannot
+  // be pushed to the heap of the fake AMX during a nested invocation. Natives may legitimately
+  // return -1 as well, so |success|, when given, will be set to whether the native was invoked.
+  int CallFunction(int native_id, const char* format, void** arguments, bool* success = nullptr);
 
  private:
   using NativeFn = int32_t(AMX* amx, int32_t* params);
 
-  // Map from the name of a native function to the pointer that represents said function. This map
-  // will be complete before the first gamemode loads.
-  std::unordered_map<std::string, NativeFn*> native_functions_;
+  // Information about a registered native function. Details that depend on the name of the native
+  // are computed at registration time, so that invocations don't have to consider the name.
+  struct NativeFunction {
+    std::string name;
+    NativeFn* function;
+
+    // Offset between an array parameter and the parameter that contains its size.
+    size_t array_size_offset;
+
+    // Whether this is CreateDynamicPolygonEx, which has two arrays with differing size offsets.
+    bool is_create_dynamic_polygon_ex;
+  };
+
+  // Vector of the registered native functions, indexed by their Id. This vector will be complete
+  // before the first gamemode loads.
+  std::vector<NativeFunction> native_functions_;
+
+  // Map from the name of a native function to its Id in |native_functions_|.
+  std::unordered_map<std::string, int> native_ids_;
+
+  // Observer to inform of natives that have been registered, if any.
+  RegistrationObserver registration_observer_;
 
-  // Reusable parameter vector to prevent heap allocations for each function invocation.
-  std::vector<int32_t> params_;
+  // Maximum number of parameters that may be passed to a native function.
+  static constexpr size_t kMaxParameters = 64;
 
   // Rather than using a live mode to invoke methods on the SA-MP server and plugins, we fake an
   // AMX environment to minimize chances of disruption.
@@ -0,0 +1,159 @@
+// Copyright 2020 Las Venturas Playground. All rights reserved.
+// Use of this source code is governed by the MIT license, a copy of which can
+// be found in the LICENSE file.
+
+#include "plugin/native_function_manager.h"
+
+#include <string.h>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "plugin/sdk/amx.h"
+
+namespace plugin {
+
+namespace {
+
+// Implementation of GetPlayerName(playerid, name[], len), which writes the player's name to the
+// |name| buffer on the heap of the |amx|, as the SA-MP server would.
+cell AMX_NATIVE_CALL GetPlayerNameNative(AMX* amx, cell* params) {
+  const std::string name = "Player" + std::to_string(params[1]);
+
+  cell* destination = reinterpret_cast<cell*>(amx->data + params[2]);
+  const size_t length = std::min(name.size(), static_cast<size_t>(params[3]) - 1);
+
+  for (size_t index = 0; index < length; ++index)
+    destination[index] = name[index];
+
+  destination[length] = 0;
+  return static_cast<cell>(length);
+}
+
+// Implementation of a native that returns -1, as natives such as GetPlayerVehicleSeat legitimately do.
+cell AMX_NATIVE_CALL ReturnMinusOneNative(AMX* amx, cell* params) {
+  return -1;
+}
+
+}  // namespace
+
+TEST(NativeFunctionManagerTest, StringReferenceArguments) {
+  NativeFunctionManager manager;
+
+  AMX_NATIVE_INFO natives[] = {
+    { "GetPlayerName", GetPlayerNameNative },
+    { nullptr, nullptr }
+  };
+
+  manager.OnRegister(nullptr, natives, 1);
+
+  const int native_id = manager.GetNativeId("GetPlayerName");
+  ASSERT_NE(NativeFunctionManager::kInvalidNativeId, native_id);
+
+  // String references are passed as an array of |capacity| cells followed by the capacity, which
+  // is how PawnInvoke passes 'S' arguments. The buffer must be able to hold that many cells.
+  for (int32_t capacity : { 4, 24, 3072 }) {
+    std::vector<cell> buffer(capacity, 0);
+    int32_t player_id = 42;
+
+    void* arguments[] = { &player_id, buffer.data(), &capacity };
+    const int result = manager.CallFunction(native_id, "iai", arguments);
+
+    const std::string expected = std::string("Player42").substr(0, capacity - 1);
+
+    EXPECT_EQ(static_cast<int>(expected.size()), result);
+    EXPECT_EQ(expected, std::string(reinterpret_cast<char*>(buffer.data())));
+  }
+}
+
+TEST(NativeFunctionManagerTest, RegistrationObserver) {
+  NativeFunctionManager manager;
+
+  std::vector<std::pair<std::string, int>> registered;
+  manager.set_registration_observer([&](const std::string& function_name, int native_id) {
+    registered.push_back(std::make_pair(function_name, native_id));
+  });
+
+  AMX_NATIVE_INFO natives[] = {
+    { "GetPlayerName", GetPlayerNameNative },
+    { "GetPlayerIp", GetPlayerNameNative },
+    { nullptr, nullptr }
+  };
+
+  manager.OnRegister(nullptr, natives, -1);
+
+  // Natives that have been registered before are ignored, as the first registration wins.
+  manager.OnRegister(nullptr, natives, 1);
+
+  ASSERT_EQ(2u, registered.size());
+  EXPECT_EQ(std::make_pair(std::string("GetPlayerName"), 0), registered[0]);
+  EXPECT_EQ(std::make_pair(std::string("GetPlayerIp"), 1), registered[1]);
+  EXPECT_EQ(1, manager.GetNativeId("GetPlayerIp"));
+
+  EXPECT_TRUE(manager.IsValidNativeId(1));
+  EXPECT_FALSE(manager.IsValidNativeId(2));
+  EXPECT_FALSE(manager.IsValidNativeId(-1));
+}
+
+TEST(NativeFunctionManagerTest, ArraySizeOffset) {
+  NativeFunctionManager manager;
+
+  AMX_NATIVE_INFO natives[] = {
+    { "SendClientMessage", GetPlayerNameNative },
+    { "CreateDynamicObjectEx", GetPlayerNameNative },
+    { "CreateDynamicCircleEx", GetPlayerNameNative },
+    { "CreateDynamicPolygonEx", GetPlayerNameNative },
+    { nullptr, nullptr }
+  };
+
+  manager.OnRegister(nullptr, natives, -1);
+
+  EXPECT_EQ(1u, manager.GetArraySizeOffset(manager.GetNativeId("SendClientMessage"), 2));
+  EXPECT_EQ(5u, manager.GetArraySizeOffset(manager.GetNativeId("CreateDynamicObjectEx"), 11));
+  EXPECT_EQ(4u, manager.GetArraySizeOffset(manager.GetNativeId("CreateDynamicCircleEx"), 4));
+  EXPECT_EQ(3u, manager.GetArraySizeOffset(manager.GetNativeId("CreateDynamicPolygonEx"), 0));
+  EXPECT_EQ(4u, manager.GetArraySizeOffset(manager.GetNativeId("CreateDynamicPolygonEx"), 5));
+
+  // Unknown natives, for example public functions, pass the size in the next argument.
+  EXPECT_EQ(1u, manager.GetArraySizeOffset(NativeFunctionManager::kInvalidNativeId, 0));
+}
+
+TEST(NativeFunctionManagerTest, ReportsFailureSeparately) {
+  NativeFunctionManager manager;
+
+  AMX_NATIVE_INFO natives[] = {
+    { "GetPlayerVehicleSeat", ReturnMinusOneNative },
+    { nullptr, nullptr }
+  };
+
+  manager.OnRegister(nullptr, natives, 1);
+
+  const int native_id = manager.GetNativeId("GetPlayerVehicleSeat");
+  ASSERT_NE(NativeFunctionManager::kInvalidNativeId, native_id);
+
+  int32_t player_id = 0;
+  int32_t size = 4;
+  cell buffer[4] = { 0 };
+
+  bool success = false;
+  void* arguments[] = { &player_id, buffer, &player_id };
+
+  // A native returning -1 has still been invoked successfully.
+  EXPECT_EQ(-1, manager.CallFunction(native_id, "i", arguments, &success));
+  EXPECT_TRUE(success);
+
+  // Unknown natives, too many parameters and arrays without size cannot be invoked.
+  EXPECT_EQ(-1, manager.CallFunction(native_id + 1, "i", arguments, &success));
+  EXPECT_FALSE(success);
+
+  success = true;
+  EXPECT_EQ(-1, manager.CallFunction(native_id, std::string(65, 'i').c_str(), arguments, &success));
+  EXPECT_FALSE(success);
+
+  success = true;
+  void* array_arguments[] = { &player_id, buffer, &size };
+  EXPECT_EQ(-1, manager.CallFunction(native_id, "iaf", array_arguments, &success));
+  EXPECT_FALSE(success);
+}
+
+}  // namespace plugin
@@ -5,10 +5,13 @@
 #include "playground/plugin/native_parser.h"
 
 #include <algorithm>
+#include <array>
 #include <fstream>
 #include <set>
+#include <stdlib.h>
 #include <streambuf>
 #include <string.h>
+#include <utility>
 
 #include "base/file_path.h"
 #include "base/logging.h"
@@ -27,9 +30,6 @@ namespace {
 // The whitespace characters as specified by CSS 2.1.
 const char kWhitespaceCharacters[] = "\x09\x0A\x0C\x0D\x20";
 
-// The global instance of the NativeParser object. Required for the native functions themselves.
-NativeParser* g_native_parser = nullptr;
-
 // Removes all whitespace from the front and back of |string|, and returns the result.
 base::StringPiece Trim(const base::StringPiece& input) {
   if (input.empty())
@@ -52,35 +52,25 @@ bool IsValidCharacter(char character) {
          (character >= '0' && character <= '9') || character == '_';
 }
 
-// Registers |N| native functions, creates |N| functions that will automagically forward the call
-// to the ProvidedNatives bindings class when called with minimal overhead.
-template <size_t N> struct NativeRegistrar {
-  static void Register() {
-    DCHECK(g_native_parser);
-
-    constexpr size_t native_index = NativeParser::kMaxNatives - N;
-    if (native_index < g_native_parser->size()) {
-      AMX_NATIVE_INFO* native = &g_native_parser->GetDynamicNativeTable()[native_index];
-      native->name = _strdup(g_native_parser->at(native_index).c_str());
-      native->func = &NativeRegistrar<N>::Invoke;
-    }
-
-    NativeRegistrar<N - 1>::Register();
-  }
-
-  static int32_t AMX_NATIVE_CALL Invoke(AMX* amx, cell* params) {
-    DCHECK(g_native_parser);
+// Global instance of the NativeParser, should only be accessed by the trampolines.
+NativeParser* g_native_parser = nullptr;
 
-    constexpr size_t native_index = NativeParser::kMaxNatives - N;
+// Trampoline for the provided native at |Index|, forwarding calls to the ProvidedNatives bindings
+// class with minimal overhead.
+template <size_t Index>
+int32_t AMX_NATIVE_CALL InvokeProvidedNative(AMX* amx, cell* params) {
+  return g_native_parser ? g_native_parser->CallProvidedNative(Index, amx, params) : 0;
+}
 
-    NativeParameters parameters(amx, params);
-    return bindings::ProvidedNatives::GetInstance()->Call(g_native_parser->at(native_index), parameters);
-  }
-};
+template <size_t... Indices>
+constexpr std::array<AMX_NATIVE, sizeof...(Indices)> CreateTrampolines(
+    std::index_sequence<Indices...>) {
+  return {{ &InvokeProvidedNative<Indices>... }};
+}
 
-template <> struct NativeRegistrar<0> {
-  static void Register() {}
-};
+// Table of the trampolines for each of the natives that can be provided by JavaScript.
+constexpr std::array<AMX_NATIVE, NativeParser::kMaxNatives> kTrampolines =
+    CreateTrampolines(std::make_index_sequence<NativeParser::kMaxNatives>());
 
 }  // namespace
 
@@ -101,11 +91,15 @@ std::unique_ptr<NativeParser> NativeParser::FromFile(const base::FilePath& filen
 
 NativeParser::NativeParser() {
   g_native_parser = this;
-  memset(native_table_, 0, sizeof(native_table_));
 }
 
 NativeParser::~NativeParser() {
-  g_native_parser = nullptr;
+  if (g_native_parser == this)
+    g_native_parser = nullptr;
+
+  // Names of the static natives have been duplicated by SetStaticNative().
+  for (size_t index = 0; index < kStaticNatives && index < native_table_.size(); ++index)
+    free(const_cast<char*>(native_table_[index].name));
 }
 
 size_t NativeParser::size() const {
@@ -120,16 +114,31 @@ const std::string& NativeParser::at(size_t index) const {
 void NativeParser::SetStaticNative(size_t index, const std::string& name, AMX_NATIVE function) {
   DCHECK(index < kStaticNatives);
 
+  DCHECK(index < native_table_.size());
+
   AMX_NATIVE_INFO* native = &native_table_[index];
+  free(const_cast<char*>(native->name));
+
   native->name = _strdup(name.c_str());
   native->func = function;
 }
 
+int32_t NativeParser::CallProvidedNative(size_t index, AMX* amx, cell* params) {
+  if (call_observer_)
+    call_observer_();
+
+  bindings::ProvidedNatives* provided_natives = bindings::ProvidedNatives::GetInstance();
+  if (!provided_natives)
+    return 0;  // testing
+
+  NativeParameters parameters(amx, params);
+  return provided_natives->Call(index, parameters);
+}
+
 bool NativeParser::Parse(const std::string& content) {
   base::StringPiece content_lines(content);
-  if (!content_lines.length())
-    return true;  // empty contents
 
+  // Empty contents are valid, in which case the native table only contains the static natives.
   size_t start = 0;
   while (start != base::StringPiece::npos) {
     size_t end = content_lines.find_first_of("\n", start);
@@ -156,11 +165,13 @@ bool NativeParser::Parse(const std::string& content) {
   }
 
   if (natives_.size() > kMaxNatives) {
-    LOG(ERROR) << "No more than " << kMaxNatives << " may be defined in natives.txt.";
+    LOG(ERROR) << "No more than " << kMaxNatives << " natives may be defined in natives.txt.";
     return false;
   }
 
-  bindings::ProvidedNatives::GetInstance()->SetNatives(natives_);
+  if (bindings::ProvidedNatives* provided_natives = bindings::ProvidedNatives::GetInstance())
+    provided_natives->SetNatives(natives_);  // not available when testing
+
   BuildNativeTable();
 
   return true;
@@ -185,7 +196,15 @@ bool NativeParser::ParseLine(base::StringPiece line) {
 }
 
 void NativeParser::BuildNativeTable() {
-  NativeRegistrar<kMaxNatives>::Register();
+  // The static natives come first, followed by the provided natives and the terminating entry.
+  // Names of the provided natives refer to |natives_|, which won't change after parsing.
+  native_table_.assign(kStaticNatives + natives_.size() + 1, AMX_NATIVE_INFO { nullptr, nullptr });
+
+  for (size_t index = 0; index < natives_.size(); ++index) {
+    AMX_NATIVE_INFO* native = &native_table_[kStaticNatives + index];
+    native->name = natives_[index].c_str();
+    native->func = kTrampolines[index];
+  }
 }
 
 }  // namespace plugin
@@ -5,6 +5,7 @@
 #ifndef PLAYGROUND_PLUGIN_NATIVE_PARSER_H_
 #define PLAYGROUND_PLUGIN_NATIVE_PARSER_H_
 
+#include <functional>
 #include <memory>
 #include <string>
 #include <vector>
@@ -21,14 +22,22 @@ namespace plugin {
 
 // Parses the list of native functions supported by the plugin from a given input file. They
 // will be registered when the AMX files load.
+//
+// The native table is built from the parsed list, and is sized accordingly. AMX native functions
+// don't receive any context, so each provided native is routed through its own trampoline, which
+// passes its index to the ProvidedNatives class. The trampolines are generated at compile time.
 class NativeParser {
  public:
-  // The maximum number of native functions that may be defined by the parser.
-  static constexpr size_t kMaxNatives = 255;
+  // The maximum number of native functions that may be defined by the parser, which is equal to
+  // the number of generated trampolines.
+  static constexpr size_t kMaxNatives = 4096;
 
   // The number of static natives (i.e. not provided by JavaScript).
-  static constexpr size_t kStaticNatives = 1;
+  static constexpr size_t kStaticNatives = 2;
    
+  // Called when Pawn calls one of the provided natives, before the call is forwarded to JavaScript.
+  using CallObserver = std::function<void()>;
+
   // Loads the list of native functions from |filename|.
   static std::unique_ptr<NativeParser> FromFile(const base::FilePath& filename);
 
@@ -43,11 +52,15 @@ class NativeParser {
   // Sets the static native at |index| to the |function| named |name|.
   void SetStaticNative(size_t index, const std::string& name, AMX_NATIVE function);
 
-  // Gets the table of native AMX functions to be shared with the SA-MP server.
-  AMX_NATIVE_INFO* GetNativeTable() { return native_table_; }
+  // Gets the table of native AMX functions to be shared with the SA-MP server. The table will be
+  // terminated by an entry without a name, as is expected by amx_Register().
+  AMX_NATIVE_INFO* GetNativeTable() { return native_table_.data(); }
+
+  // Sets the |observer| to be invoked for calls to the provided natives.
+  void set_call_observer(CallObserver observer) { call_observer_ = std::move(observer); }
 
-  // Gets the table of native AMX functions that have been dynamically inserted by JavaScript.
-  AMX_NATIVE_INFO* GetDynamicNativeTable() { return &native_table_[kStaticNatives]; }
+  // Calls the provided native at |index| on behalf of the |amx|. Used by the trampolines.
+  int32_t CallProvidedNative(size_t index, AMX* amx, cell* params);
 
  private:
   NativeParser();
@@ -62,9 +75,12 @@ class NativeParser {
   // Set of the native functions that have been registered by the parser.
   std::vector<std::string> natives_;
 
-  // The native table has to be of a fixed size and should be frozen after all native functions
-  // have been loaded. This will be used by the SA-MP server to load natives from this module.
-  AMX_NATIVE_INFO native_table_[kMaxNatives + kStaticNatives + 1];
+  // The native table is built once all native functions have been loaded, and must not change
+  // afterwards. This will be used by the SA-MP server to load natives from this module.
+  std::vector<AMX_NATIVE_INFO> native_table_;
+
+  // Observer to invoke for calls to the provided natives, if any.
+  CallObserver call_observer_;
 
   DISALLOW_COPY_AND_ASSIGN(NativeParser);
 };
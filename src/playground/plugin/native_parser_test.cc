@@ -0,0 +1,72 @@
+// Copyright 2020 Las Venturas Playground. All rights reserved.
+// Use of this source code is governed by the MIT license, a copy of which can
+// be found in the LICENSE file.
+
+#include "plugin/native_parser.h"
+
+#include <boost/filesystem.hpp>
+#include <fstream>
+
+#include "base/file_path.h"
+#include "gtest/gtest.h"
+
+namespace fs = boost::filesystem;
+
+namespace plugin {
+
+namespace {
+
+// Writes |content| to a temporary file, and returns the native parser created for it.
+std::unique_ptr<NativeParser> CreateParser(const std::string& content) {
+  const fs::path path = fs::temp_directory_path() / fs::unique_path();
+  {
+    std::ofstream file(path.string().c_str());
+    file << content;
+  }
+
+  std::unique_ptr<NativeParser> parser = NativeParser::FromFile(base::FilePath(path.string()));
+
+  fs::remove(path);
+  return parser;
+}
+
+cell AMX_NATIVE_CALL StaticNative(AMX* amx, cell* params) {
+  return 1;
+}
+
+}  // namespace
+
+TEST(NativeParserTest, EmptyFile) {
+  std::unique_ptr<NativeParser> parser = CreateParser("");
+  ASSERT_TRUE(parser);
+  EXPECT_EQ(0u, parser->size());
+
+  // The static natives must still be available in the native table.
+  parser->SetStaticNative(0, "StaticNativeA", StaticNative);
+  parser->SetStaticNative(1, "StaticNativeB", StaticNative);
+
+  AMX_NATIVE_INFO* native_table = parser->GetNativeTable();
+  ASSERT_TRUE(native_table);
+
+  EXPECT_STREQ("StaticNativeA", native_table[0].name);
+  EXPECT_STREQ("StaticNativeB", native_table[1].name);
+  EXPECT_EQ(nullptr, native_table[NativeParser::kStaticNatives].name);
+}
+
+TEST(NativeParserTest, ProvidedNatives) {
+  std::unique_ptr<NativeParser> parser = CreateParser("# Comment\nIsPlayerMinimized\n\nGetPlayerTeleportStatus\n");
+  ASSERT_TRUE(parser);
+  ASSERT_EQ(2u, parser->size());
+  EXPECT_EQ("IsPlayerMinimized", parser->at(0));
+
+  AMX_NATIVE_INFO* native_table = parser->GetNativeTable();
+  EXPECT_STREQ("IsPlayerMinimized", native_table[NativeParser::kStaticNatives].name);
+  EXPECT_STREQ("GetPlayerTeleportStatus", native_table[NativeParser::kStaticNatives + 1].name);
+  EXPECT_TRUE(native_table[NativeParser::kStaticNatives + 1].func);
+  EXPECT_EQ(nullptr, native_table[NativeParser::kStaticNatives + 2].name);
+
+  EXPECT_FALSE(CreateParser("Invalid-Name\n"));
+  EXPECT_FALSE(CreateParser("Duplicate\nDuplicate\n"));
+}
+
+}  // namespace plugin
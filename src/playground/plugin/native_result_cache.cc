@@ -0,0 +1,231 @@
+// Copyright 2020 Las Venturas Playground. All rights reserved.
+// Use of this source code is governed by the MIT license, a copy of which can
+// be found in the LICENSE file.
+
+#include "plugin/native_result_cache.h"
+
+#include <fstream>
+#include <streambuf>
+#include <string.h>
+
+#include "base/file_path.h"
+#include "base/logging.h"
+
+namespace plugin {
+namespace {
+
+// The whitespace characters as specified by CSS 2.1.
+const char kWhitespaceCharacters[] = "\x09\x0A\x0C\x0D\x20";
+
+// Removes all whitespace from the front and back of |string|, and returns the result.
+base::StringPiece Trim(const base::StringPiece& input) {
+  if (input.empty())
+    return input;
+
+  const size_t first_good_char = input.find_first_not_of(kWhitespaceCharacters);
+  const size_t last_good_char = input.find_last_not_of(kWhitespaceCharacters);
+
+  if (first_good_char == base::StringPiece::npos ||
+      last_good_char == base::StringPiece::npos)
+    return base::StringPiece();
+
+  return input.substr(first_good_char, last_good_char - first_good_char + 1);
+}
+
+// Returns whether |character| is valid for use in a native function name.
+bool IsValidCharacter(char character) {
+  return (character >= 'A' && character <= 'Z') ||
+         (character >= 'a' && character <= 'z') ||
+         (character >= '0' && character <= '9') || character == '_';
+}
+
+}  // namespace
+
+bool NativeResultCache::CacheKey::operator==(const CacheKey& other) const {
+  if (native_id != other.native_id || parameter_count != other.parameter_count)
+    return false;
+
+  return !memcmp(inputs, other.inputs, parameter_count * sizeof(int32_t));
+}
+
+size_t NativeResultCache::CacheKeyHash::operator()(const CacheKey& key) const {
+  size_t hash = static_cast<size_t>(key.native_id) * 31 + key.parameter_count;
+  for (size_t index = 0; index < key.parameter_count; ++index)
+    hash = hash * 31 + static_cast<uint32_t>(key.inputs[index]);
+
+  return hash;
+}
+
+// static
+std::unique_ptr<NativeResultCache> NativeResultCache::FromFile(const base::FilePath& filename) {
+  std::ifstream file(filename.value().c_str());
+  if (!file.is_open() || file.fail())
+    return nullptr;
+
+  std::string content((std::istreambuf_iterator<char>(file)),
+                       std::istreambuf_iterator<char>());
+
+  return FromString(content);
+}
+
+// static
+std::unique_ptr<NativeResultCache> NativeResultCache::FromString(const std::string& content) {
+  std::unique_ptr<NativeResultCache> cache(new NativeResultCache);
+  if (!cache->Parse(content))
+    return nullptr;
+
+  return cache;
+}
+
+NativeResultCache::NativeResultCache() = default;
+
+NativeResultCache::~NativeResultCache() = default;
+
+bool NativeResultCache::IsCacheable(const std::string& function_name) const {
+  return cacheable_natives_.find(function_name) != cacheable_natives_.end();
+}
+
+void NativeResultCache::RegisterNative(const std::string& function_name, int native_id) {
+  if (native_id < 0 || !IsCacheable(function_name))
+    return;
+
+  if (native_id >= static_cast<int>(cacheable_native_ids_.size()))
+    cacheable_native_ids_.resize(native_id + 1, false);
+
+  cacheable_native_ids_[native_id] = true;
+}
+
+bool NativeResultCache::Lookup(int native_id, const char* format, void** arguments,
+                               int* return_value) {
+  CacheKey key;
+  if (!CreateKey(native_id, format, arguments, &key))
+    return false;
+
+  auto entry_iter = entries_.find(key);
+  if (entry_iter == entries_.end())
+    return false;
+
+  const CacheEntry& entry = entry_iter->second;
+  if (entry.epoch != epoch_)
+    return false;  // all entries have been invalidated since
+
+  if (key.parameter_count && entry.target_generation != target_generation(key.inputs[0]))
+    return false;  // the entry's target has been invalidated since
+
+  for (size_t index = 0; index < key.parameter_count; ++index) {
+    if (format[index] == 'r')
+      *reinterpret_cast<int32_t*>(arguments[index]) = entry.outputs[index];
+  }
+
+  *return_value = entry.return_value;
+  return true;
+}
+
+void NativeResultCache::Store(int native_id, const char* format, void** arguments,
+                              int return_value) {
+  CacheKey key;
+  if (!CreateKey(native_id, format, arguments, &key))
+    return;
+
+  if (entries_.size() >= kMaxEntries)
+    entries_.clear();
+
+  CacheEntry& entry = entries_[key];
+  entry.epoch = epoch_;
+  entry.target_generation = key.parameter_count ? target_generation(key.inputs[0]) : 0;
+  entry.return_value = return_value;
+
+  for (size_t index = 0; index < key.parameter_count; ++index) {
+    if (format[index] == 'r')
+      entry.outputs[index] = *reinterpret_cast<int32_t*>(arguments[index]);
+  }
+}
+
+void NativeResultCache::Invalidate(int32_t target) {
+  ++target_generation(target);
+}
+
+void NativeResultCache::InvalidateAll() {
+  ++epoch_;
+}
+
+bool NativeResultCache::Parse(const std::string& content) {
+  base::StringPiece content_lines(content);
+  if (!content_lines.length())
+    return true;  // empty contents
+
+  size_t start = 0;
+  while (start != base::StringPiece::npos) {
+    size_t end = content_lines.find_first_of("\n", start);
+
+    base::StringPiece line;
+    if (end == base::StringPiece::npos) {
+      line = content_lines.substr(start);
+      start = end;
+    } else {
+      line = content_lines.substr(start, end - start);
+      start = end + 1;
+    }
+
+    line = Trim(line);
+    if (line.empty())
+      continue;  // do not process empty lines.
+
+    if (line.starts_with("#") || line.starts_with("//"))
+      continue;  // comment line.
+
+    if (!ParseLine(line))
+      return false;
+  }
+
+  return true;
+}
+
+bool NativeResultCache::ParseLine(base::StringPiece line) {
+  for (size_t i = 0; i < line.length(); ++i) {
+    if (!IsValidCharacter(line[i])) {
+      LOG(ERROR) << "Invalid cacheable native function name: " << line.as_string();
+      return false;
+    }
+  }
+
+  const std::string name = line.as_string();
+  if (cacheable_natives_.count(name)) {
+    LOG(ERROR) << "Cacheable native has been listed multiple times: " << name;
+    return false;
+  }
+
+  cacheable_natives_.insert(name);
+  return true;
+}
+
+bool NativeResultCache::CreateKey(int native_id, const char* format, void** arguments,
+                                  CacheKey* key) const {
+  if (!IsCacheable(native_id))
+    return false;
+
+  const size_t parameter_count = format ? strlen(format) : 0;
+  if (parameter_count > kMaxParameters)
+    return false;
+
+  key->native_id = native_id;
+  key->parameter_count = parameter_count;
+
+  for (size_t index = 0; index < parameter_count; ++index) {
+    switch (format[index]) {
+    case 'i':
+    case 'f':
+      key->inputs[index] = *reinterpret_cast<int32_t*>(arguments[index]);
+      break;
+    case 'r':
+      key->inputs[index] = 0;  // output values do not contribute to the key.
+      break;
+    default:
+      return false;  // strings and arrays cannot be cached.
+    }
+  }
+
+  return true;
+}
+
+}  // namespace plugin
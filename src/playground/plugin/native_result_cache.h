@@ -0,0 +1,150 @@
+// Copyright 2020 Las Venturas Playground. All rights reserved.
+// Use of this source code is governed by the MIT license, a copy of which can
+// be found in the LICENSE file.
+
+#ifndef PLAYGROUND_PLUGIN_NATIVE_RESULT_CACHE_H_
+#define PLAYGROUND_PLUGIN_NATIVE_RESULT_CACHE_H_
+
+#include <stdint.h>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "base/macros.h"
+#include "base/string_piece.h"
+
+namespace base {
+class FilePath;
+}
+
+namespace plugin {
+
+// Caches the results of idempotent, read-only native functions (e.g. GetPlayerPos) for as long as
+// no Pawn code runs, which in practice is the dispatch of a single callback or timer. Independent
+// JavaScript features tend to call the same getters for the same player many times while handling
+// an event, each of which would otherwise cross into the AMX.
+//
+// Pawn code may call mutating natives directly, which doesn't go through the plugin, so it's not
+// possible to narrow invalidation to the scripts that actually changed state.
+//
+// The natives that may be cached are listed in an on-disk file, one name per line. Only natives
+// whose parameters are integers, floats and references ([ifr]) can be cached. Results are keyed
+// on the native and its input values, and will be returned for as long as they're valid:
+//
+//   - All entries will be invalidated when the server starts a new frame, when a Pawn public
+//     function is called, when any callback has been intercepted, when Pawn calls one of the
+//     natives provided by JavaScript, and when the Pawn runtime has finished executing code.
+//   - Entries whose first argument (the "target", e.g. the playerid) equals the first argument of
+//     a non-cacheable native will be invalidated, as such natives are considered to be mutating.
+//     All entries will be invalidated for non-cacheable natives without such a target.
+//   - Entries for a given player will be invalidated when they send an update to the server.
+class NativeResultCache {
+ public:
+  // Loads the list of cacheable native functions from |filename|. Returns a nullptr when the file
+  // cannot be read, or contains syntax errors.
+  static std::unique_ptr<NativeResultCache> FromFile(const base::FilePath& filename);
+
+  // Creates a NativeResultCache for the natives listed in |content|.
+  static std::unique_ptr<NativeResultCache> FromString(const std::string& content);
+
+  ~NativeResultCache();
+
+  // Returns whether the native named |function_name| may be cached.
+  bool IsCacheable(const std::string& function_name) const;
+
+  // Returns whether the native identified by |native_id| may be cached.
+  bool IsCacheable(int native_id) const {
+    return native_id >= 0 && native_id < static_cast<int>(cacheable_native_ids_.size()) &&
+           cacheable_native_ids_[native_id];
+  }
+
+  // Associates the |native_id| with the native named |function_name|, to be called once for each
+  // native when it has been registered with the Pawn runtime.
+  void RegisterNative(const std::string& function_name, int native_id);
+
+  // Attempts to find a cached result for |native_id| called with |arguments| in |format|. The
+  // |return_value| and all reference arguments will be written to when it could be found.
+  bool Lookup(int native_id, const char* format, void** arguments, int* return_value);
+
+  // Stores the |return_value| and reference arguments for |native_id| in the cache.
+  void Store(int native_id, const char* format, void** arguments, int return_value);
+
+  // Invalidates all cached entries whose first argument is equal to |target|.
+  void Invalidate(int32_t target);
+
+  // Invalidates all cached entries. This is an O(1) operation, as stale entries will be replaced
+  // when they're next stored rather than being removed from the cache.
+  void InvalidateAll();
+
+  // Returns the number of natives that may be cached.
+  size_t size() const { return cacheable_natives_.size(); }
+
+ private:
+  // Maximum number of parameters that a cacheable native function may accept.
+  static constexpr size_t kMaxParameters = 8;
+
+  // Maximum number of entries in the cache before it will be cleared altogether.
+  static constexpr size_t kMaxEntries = 16384;
+
+  // Number of distinct target generations. Targets sharing a bucket are invalidated together,
+  // which is conservative but correct.
+  static constexpr size_t kTargetGenerationCount = 1024;
+
+  struct CacheKey {
+    int native_id;
+    size_t parameter_count;
+    int32_t inputs[kMaxParameters];
+
+    bool operator==(const CacheKey& other) const;
+  };
+
+  struct CacheKeyHash {
+    size_t operator()(const CacheKey& key) const;
+  };
+
+  struct CacheEntry {
+    uint32_t epoch;
+    uint32_t target_generation;
+
+    int return_value;
+    int32_t outputs[kMaxParameters];
+  };
+
+  NativeResultCache();
+
+  // Parses the |content| as the list of cacheable natives.
+  bool Parse(const std::string& content);
+  bool ParseLine(base::StringPiece line);
+
+  // Builds the |key| for |native_id| invoked with |arguments| in |format|. Returns false when the
+  // invocation cannot be cached, for example because the native is not cacheable.
+  bool CreateKey(int native_id, const char* format, void** arguments, CacheKey* key) const;
+
+  // Returns a reference to the generation counter for the given |target|.
+  uint32_t& target_generation(int32_t target) {
+    return target_generations_[static_cast<uint32_t>(target) % kTargetGenerationCount];
+  }
+
+  // Set of the names of the cacheable natives.
+  std::unordered_set<std::string> cacheable_natives_;
+
+  // Vector indicating whether the native having a particular Id may be cached.
+  std::vector<bool> cacheable_native_ids_;
+
+  // The cached results. Entries are lazily invalidated through the epoch and generations.
+  std::unordered_map<CacheKey, CacheEntry, CacheKeyHash> entries_;
+
+  // Incremented when all entries have been invalidated.
+  uint32_t epoch_ = 0;
+
+  // Generation counters for invalidating entries associated with a particular target.
+  uint32_t target_generations_[kTargetGenerationCount] = { 0 };
+
+  DISALLOW_COPY_AND_ASSIGN(NativeResultCache);
+};
+
+}  // namespace plugin
+
+#endif  // PLAYGROUND_PLUGIN_NATIVE_RESULT_CACHE_H_
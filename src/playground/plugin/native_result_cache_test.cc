@@ -0,0 +1,128 @@
+// Copyright 2020 Las Venturas Playground. All rights reserved.
+// Use of this source code is governed by the MIT license, a copy of which can
+// be found in the LICENSE file.
+
+#include "plugin/native_result_cache.h"
+
+#include <boost/filesystem.hpp>
+#include <fstream>
+
+#include "base/file_path.h"
+#include "gtest/gtest.h"
+#include "plugin/native_parser.h"
+
+namespace fs = boost::filesystem;
+
+namespace plugin {
+
+namespace {
+
+// Writes |content| to a temporary file, and returns the native parser created for it.
+std::unique_ptr<NativeParser> CreateParser(const std::string& content) {
+  const fs::path path = fs::temp_directory_path() / fs::unique_path();
+  {
+    std::ofstream file(path.string().c_str());
+    file << content;
+  }
+
+  std::unique_ptr<NativeParser> parser = NativeParser::FromFile(base::FilePath(path.string()));
+
+  fs::remove(path);
+  return parser;
+}
+
+}  // namespace
+
+TEST(NativeResultCacheTest, ParseList) {
+  std::unique_ptr<NativeResultCache> cache =
+      NativeResultCache::FromString("# Comment\nGetPlayerPos\n\n  IsPlayerConnected  \n");
+
+  ASSERT_TRUE(cache);
+  EXPECT_EQ(2u, cache->size());
+  EXPECT_TRUE(cache->IsCacheable("GetPlayerPos"));
+  EXPECT_TRUE(cache->IsCacheable("IsPlayerConnected"));
+  EXPECT_FALSE(cache->IsCacheable("SetPlayerPos"));
+
+  EXPECT_FALSE(NativeResultCache::FromString("Get Player Pos"));
+  EXPECT_FALSE(NativeResultCache::FromString("GetPlayerPos\nGetPlayerPos"));
+}
+
+TEST(NativeResultCacheTest, LookupAndInvalidate) {
+  std::unique_ptr<NativeResultCache> cache = NativeResultCache::FromString("GetPlayerHealth");
+  ASSERT_TRUE(cache);
+
+  cache->RegisterNative("GetPlayerHealth", 12);
+  ASSERT_TRUE(cache->IsCacheable(12));
+
+  int player_id = 42;
+  float health = 75.0f;
+  void* arguments[] = { &player_id, &health };
+
+  int result = 0;
+  EXPECT_FALSE(cache->Lookup(12, "ir", arguments, &result));
+
+  cache->Store(12, "ir", arguments, 1);
+
+  health = 0.0f;
+  ASSERT_TRUE(cache->Lookup(12, "ir", arguments, &result));
+  EXPECT_EQ(1, result);
+  EXPECT_EQ(75.0f, health);
+
+  cache->Invalidate(player_id);
+  EXPECT_FALSE(cache->Lookup(12, "ir", arguments, &result));
+
+  cache->Store(12, "ir", arguments, 1);
+  EXPECT_TRUE(cache->Lookup(12, "ir", arguments, &result));
+
+  cache->InvalidateAll();
+  EXPECT_FALSE(cache->Lookup(12, "ir", arguments, &result));
+}
+
+TEST(NativeResultCacheTest, UncacheableInvocations) {
+  std::unique_ptr<NativeResultCache> cache = NativeResultCache::FromString("GetPlayerName");
+  ASSERT_TRUE(cache);
+
+  cache->RegisterNative("GetPlayerName", 0);
+  cache->RegisterNative("GetPlayerPos", 1);
+  EXPECT_FALSE(cache->IsCacheable(1));
+
+  int player_id = 0;
+  char buffer[24] = { 0 };
+  int buffer_size = sizeof(buffer);
+  void* arguments[] = { &player_id, buffer, &buffer_size };
+
+  int result = 0;
+  cache->Store(0, "iai", arguments, 1);
+  EXPECT_FALSE(cache->Lookup(0, "iai", arguments, &result));
+  EXPECT_FALSE(cache->Lookup(1, "i", arguments, &result));
+}
+
+TEST(NativeResultCacheTest, MutationFromPawnBetweenCachedReads) {
+  std::unique_ptr<NativeParser> parser = CreateParser("OnPawnMutation\n");
+  ASSERT_TRUE(parser);
+
+  std::unique_ptr<NativeResultCache> cache = NativeResultCache::FromString("GetPlayerHealth");
+  ASSERT_TRUE(cache);
+
+  cache->RegisterNative("GetPlayerHealth", 0);
+  parser->set_call_observer([&cache]() { cache->InvalidateAll(); });
+
+  int player_id = 0;
+  float health = 100.0f;
+  void* arguments[] = { &player_id, &health };
+
+  int result = 0;
+  cache->Store(0, "ir", arguments, 1);
+  ASSERT_TRUE(cache->Lookup(0, "ir", arguments, &result));
+
+  // Pawn changes the player's health, and then calls in to JavaScript through a provided native.
+  // The second read must not be served from the cache.
+  cell params[] = { 0 };
+
+  AMX_NATIVE_INFO* native_table = parser->GetNativeTable();
+  native_table[NativeParser::kStaticNatives].func(nullptr, params);
+
+  EXPECT_FALSE(cache->Lookup(0, "ir", arguments, &result));
+}
+
+}  // namespace plugin
@@ -9,6 +9,7 @@
 
 #include "base/logging.h"
 #include "plugin/sdk/amx.h"
+#include "plugin/string_marshalling.h"
 
 namespace plugin {
 
@@ -67,23 +68,13 @@ const std::string& ReadStringFromAmx(AMX* amx, int string_index, std::string* bu
     return *buffer;
   }
 
-  int string_length = 0;
-  if (amx_StrLen(string_address, &string_length) != AMX_ERR_NONE) {
-    LOG(ERROR) << "Unable to read the length of a string argument.";
-    return *buffer;
-  }
-
+  const size_t string_length = GetStringLength(string_address);
   if (!string_length)
     return *buffer;
 
   buffer->resize(string_length + 1, '\0');
+  buffer->resize(NarrowString(string_address, &*buffer->begin(), string_length + 1));
 
-  if (amx_GetString(&*buffer->begin(), string_address, 0, string_length + 1) != AMX_ERR_NONE) {
-    LOG(ERROR) << "Unable to copy the string from the Pawn runtime.";
-    return *buffer;
-  }
-
-  buffer->resize(string_length);
   return *buffer;
 }
 
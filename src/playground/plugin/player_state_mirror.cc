@@ -0,0 +1,53 @@
+// Copyright 2020 Las Venturas Playground. All rights reserved.
+// Use of this source code is governed by the MIT license, a copy of which can
+// be found in the LICENSE file.
+
+#include "plugin/player_state_mirror.h"
+
+namespace plugin {
+
+PlayerStateMirror::PlayerStateMirror()
+    : floats_(FLOAT_FIELD_COUNT * kMaxPlayers, 0.0f),
+      integers_(INTEGER_FIELD_COUNT * kMaxPlayers, 0),
+      update_times_(kMaxPlayers, -1),
+      refresh_times_(kMaxPlayers, -1) {}
+
+PlayerStateMirror::~PlayerStateMirror() = default;
+
+bool PlayerStateMirror::OnPlayerUpdate(int player_id, double current_time,
+                                       const Reader& reader) {
+  if (player_id < 0 || player_id >= static_cast<int>(kMaxPlayers))
+    return false;
+
+  update_times_[player_id] = current_time;
+
+  if (refresh_interval_ <= 0)
+    return false;  // mirroring has been disabled
+
+  if (refresh_times_[player_id] >= 0 &&
+      current_time - refresh_times_[player_id] < refresh_interval_) {
+    return false;  // the player's state has been refreshed recently
+  }
+
+  refresh_times_[player_id] = current_time;
+
+  PlayerState state = {};
+  reader(player_id, &state);
+
+  for (size_t field = 0; field < FLOAT_FIELD_COUNT; ++field)
+    floats_[field * kMaxPlayers + player_id] = state.floats[field];
+
+  for (size_t field = 0; field < INTEGER_FIELD_COUNT; ++field)
+    integers_[field * kMaxPlayers + player_id] = state.integers[field];
+
+  return true;
+}
+
+double PlayerStateMirror::GetLastUpdateTime(int player_id) const {
+  if (player_id < 0 || player_id >= static_cast<int>(kMaxPlayers))
+    return -1;
+
+  return update_times_[player_id];
+}
+
+}  // namespace plugin
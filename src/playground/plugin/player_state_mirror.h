@@ -0,0 +1,95 @@
+// Copyright 2020 Las Venturas Playground. All rights reserved.
+// Use of this source code is governed by the MIT license, a copy of which can
+// be found in the LICENSE file.
+
+#ifndef PLAYGROUND_PLUGIN_PLAYER_STATE_MIRROR_H_
+#define PLAYGROUND_PLUGIN_PLAYER_STATE_MIRROR_H_
+
+#include <stdint.h>
+#include <functional>
+#include <vector>
+
+#include "base/macros.h"
+
+namespace plugin {
+
+// Mirrors frequently read parts of each player's state, for example their position and health,
+// in a fixed struct-of-arrays indexed by player Id. The state of a player will be refreshed when
+// they send an update to the server, at most once per refresh interval.
+//
+// JavaScript is able to read the mirrored state through typed arrays backed by the same memory,
+// which avoids calling in to the Pawn runtime for each read. The mirrored state may be up to the
+// refresh interval old, and will not be cleared when a player disconnects from the server.
+class PlayerStateMirror {
+ public:
+  // Maximum number of players that may be connected to the server at once (MAX_PLAYERS).
+  static constexpr size_t kMaxPlayers = 1000;
+
+  // Floating point fields that will be mirrored for each player.
+  enum FloatField {
+    FLOAT_FIELD_POSITION_X,
+    FLOAT_FIELD_POSITION_Y,
+    FLOAT_FIELD_POSITION_Z,
+    FLOAT_FIELD_HEALTH,
+    FLOAT_FIELD_ARMOUR,
+
+    FLOAT_FIELD_COUNT
+  };
+
+  // Integral fields that will be mirrored for each player.
+  enum IntegerField {
+    INTEGER_FIELD_STATE,
+    INTEGER_FIELD_VEHICLE_ID,
+    INTEGER_FIELD_INTERIOR,
+    INTEGER_FIELD_VIRTUAL_WORLD,
+
+    INTEGER_FIELD_COUNT
+  };
+
+  // State of an individual player, as read by the Reader.
+  struct PlayerState {
+    float floats[FLOAT_FIELD_COUNT];
+    int32_t integers[INTEGER_FIELD_COUNT];
+  };
+
+  // Function through which the current state of a player will be read.
+  using Reader = std::function<void(int player_id, PlayerState* state)>;
+
+  PlayerStateMirror();
+  ~PlayerStateMirror();
+
+  // Called when |player_id| has sent an update to the server at |current_time|. Their state will
+  // be read through |reader| when it was last refreshed more than an interval ago. Returns whether
+  // the mirrored state was refreshed.
+  bool OnPlayerUpdate(int player_id, double current_time, const Reader& reader);
+
+  // Returns the time at which |player_id| last sent an update, or a negative number when they
+  // haven't sent any update to the server yet.
+  double GetLastUpdateTime(int player_id) const;
+
+  // Returns the mirrored values of |field| for all players, indexed by player Id. The returned
+  // memory remains valid for the lifetime of this instance.
+  float* float_field(FloatField field) { return &floats_[field * kMaxPlayers]; }
+  int32_t* integer_field(IntegerField field) { return &integers_[field * kMaxPlayers]; }
+
+  // Gets or sets the minimum interval, in milliseconds, between refreshes of a player's state.
+  // Mirroring is disabled when the interval is zero, which is the default.
+  double refresh_interval() const { return refresh_interval_; }
+  void set_refresh_interval(double refresh_interval) { refresh_interval_ = refresh_interval; }
+
+ private:
+  std::vector<float> floats_;
+  std::vector<int32_t> integers_;
+
+  // Times at which each of the players last sent an update, and last had their state refreshed.
+  std::vector<double> update_times_;
+  std::vector<double> refresh_times_;
+
+  double refresh_interval_ = 0;
+
+  DISALLOW_COPY_AND_ASSIGN(PlayerStateMirror);
+};
+
+}  // namespace plugin
+
+#endif  // PLAYGROUND_PLUGIN_PLAYER_STATE_MIRROR_H_
@@ -0,0 +1,50 @@
+// Copyright 2020 Las Venturas Playground. All rights reserved.
+// Use of this source code is governed by the MIT license, a copy of which can
+// be found in the LICENSE file.
+
+#include "plugin/player_state_mirror.h"
+
+#include "gtest/gtest.h"
+
+namespace plugin {
+
+TEST(PlayerStateMirrorTest, RefreshCadence) {
+  PlayerStateMirror mirror;
+
+  size_t reads = 0;
+  auto reader = [&](int player_id, PlayerStateMirror::PlayerState* state) {
+    state->floats[PlayerStateMirror::FLOAT_FIELD_HEALTH] = 100.0f - reads;
+    state->integers[PlayerStateMirror::INTEGER_FIELD_VEHICLE_ID] = player_id * 2;
+    ++reads;
+  };
+
+  // Mirroring is disabled by default, but update times will be recorded.
+  EXPECT_LT(mirror.GetLastUpdateTime(12), 0);
+  EXPECT_FALSE(mirror.OnPlayerUpdate(12, 1000, reader));
+  EXPECT_EQ(1000, mirror.GetLastUpdateTime(12));
+  EXPECT_EQ(0u, reads);
+
+  mirror.set_refresh_interval(100);
+
+  EXPECT_TRUE(mirror.OnPlayerUpdate(12, 1010, reader));
+  EXPECT_FALSE(mirror.OnPlayerUpdate(12, 1050, reader));
+  EXPECT_TRUE(mirror.OnPlayerUpdate(42, 1050, reader));
+  EXPECT_TRUE(mirror.OnPlayerUpdate(12, 1110, reader));
+  EXPECT_EQ(3u, reads);
+
+  const float* health = mirror.float_field(PlayerStateMirror::FLOAT_FIELD_HEALTH);
+  EXPECT_EQ(98.0f, health[12]);
+  EXPECT_EQ(99.0f, health[42]);
+  EXPECT_EQ(0.0f, health[0]);
+
+  const int32_t* vehicles = mirror.integer_field(PlayerStateMirror::INTEGER_FIELD_VEHICLE_ID);
+  EXPECT_EQ(24, vehicles[12]);
+  EXPECT_EQ(84, vehicles[42]);
+
+  // Invalid player Ids must be ignored.
+  EXPECT_FALSE(mirror.OnPlayerUpdate(-1, 2000, reader));
+  EXPECT_FALSE(mirror.OnPlayerUpdate(PlayerStateMirror::kMaxPlayers, 2000, reader));
+  EXPECT_EQ(3u, reads);
+}
+
+}  // namespace plugin
@@ -31,6 +31,9 @@ using bindings::ProvidedNatives;
 
 namespace {
 
+// Maximum number of cells in a buffer shared through RegisterSharedBuffer().
+const cell kMaxSharedBufferSize = 16 * 1024 * 1024;
+
 #define CHECK_PARAMS(n) { if (params[0] != n * sizeof(cell)) { g_logprintf("SCRIPT: Bad parameter count (%d != %d): ", params[0], n); return 0; } }
 
 // Global instance of the PluginController class, which will be kept alive for the duration of this
@@ -82,6 +85,33 @@ static cell AMX_NATIVE_CALL n_IsPlayerMinimized(AMX* amx, cell* params) {
   return 0;
 }
 
+// native RegisterSharedBuffer(const name[], buffer[], size = sizeof(buffer));
+//
+// Shares the global |buffer| with JavaScript as |name|, where it will be available as an Int32Array
+// over the same memory. The |buffer| must not be a local variable, as it has to remain valid.
+static cell AMX_NATIVE_CALL n_RegisterSharedBuffer(AMX* amx, cell* params) {
+  CHECK_PARAMS(3);
+
+  if (!g_plugin_controller)
+    return 0;
+
+  std::string name;
+  if (!GetStringFromPawnArg(amx, params[1], &name))
+    return 0;
+
+  const cell size = params[3];
+  if (size <= 0 || size > kMaxSharedBufferSize)
+    return 0;
+
+  // Verify that the entire buffer is within the AMX's data section, i.e. that it's a global array.
+  cell* data = plugin::SharedBufferRegistry::GetGlobalArray(amx, params[2], size);
+  if (!data)
+    return 0;
+
+  g_plugin_controller->RegisterSharedBuffer(name, amx, data, static_cast<size_t>(size));
+  return 1;
+}
+
 }  // namespace
 
 PLUGIN_EXPORT unsigned int PLUGIN_CALL Supports() {
@@ -116,6 +146,7 @@ PLUGIN_EXPORT bool PLUGIN_CALL Load(void **ppData) {
 
   // Register the static native functions provided by the plugin's C++ code.
   g_plugin_controller->native_parser()->SetStaticNative(/* index= */ 0, "IsPlayerMinimized", n_IsPlayerMinimized);
+  g_plugin_controller->native_parser()->SetStaticNative(/* index= */ 1, "RegisterSharedBuffer", n_RegisterSharedBuffer);
 
   return true;
 }
@@ -132,6 +163,9 @@ PLUGIN_EXPORT int PLUGIN_CALL AmxLoad(AMX *amx) {
 }
 
 PLUGIN_EXPORT int PLUGIN_CALL AmxUnload(AMX *amx) {
+  if (g_plugin_controller)
+    g_plugin_controller->OnAmxUnloaded(amx);
+
   return AMX_ERR_NONE;
 }
 
@@ -9,8 +9,11 @@
 #include "playground_controller.h"
 #include "plugin/callback_manager.h"
 #include "plugin/callback_parser.h"
+#include "plugin/deferred_native_queue.h"
 #include "plugin/native_function_manager.h"
 #include "plugin/native_parser.h"
+#include "plugin/native_result_cache.h"
+#include "plugin/player_state_mirror.h"
 #include "plugin/plugin_delegate.h"
 #include "plugin/sdk/plugincommon.h"
 
@@ -27,12 +30,43 @@ const char kCallbackFile[] = "data/server/callbacks.txt";
 // File in which the list of provided native functions are listed.
 const char kNativesFile[] = "data/server/natives.txt";
 
+// File in which the list of native functions whose results may be cached are listed.
+const char kCachedNativesFile[] = "data/server/cached_natives.txt";
+
 // Maximum number of bytes to send in a single logprintf() call.
 const size_t kLogLimit = 2048;
 
 // Number of milliseconds of no updates after which a player is considered to be idle.
 const size_t kIdleThresholdMs = 1000;
 
+// Natives through which the mirrored state of players will be read, in order of their usage by
+// PluginController::ReadPlayerState().
+const char* kPlayerStateNatives[] = {
+  "GetPlayerPos",
+  "GetPlayerHealth",
+  "GetPlayerArmour",
+  "GetPlayerState",
+  "GetPlayerVehicleID",
+  "GetPlayerInterior",
+  "GetPlayerVirtualWorld",
+};
+
+enum PlayerStateNative {
+  PLAYER_STATE_NATIVE_POSITION,
+  PLAYER_STATE_NATIVE_HEALTH,
+  PLAYER_STATE_NATIVE_ARMOUR,
+  PLAYER_STATE_NATIVE_STATE,
+  PLAYER_STATE_NATIVE_VEHICLE_ID,
+  PLAYER_STATE_NATIVE_INTERIOR,
+  PLAYER_STATE_NATIVE_VIRTUAL_WORLD,
+
+  PLAYER_STATE_NATIVE_COUNT
+};
+
+static_assert(sizeof(kPlayerStateNatives) / sizeof(kPlayerStateNatives[0]) ==
+                  PLAYER_STATE_NATIVE_COUNT,
+              "Each of the player state natives must be named.");
+
 }  // namespace
 
 PluginController::PluginController(const base::FilePath& path) {
@@ -57,6 +91,26 @@ PluginController::PluginController(const base::FilePath& path) {
     return;
   }
 
+  // Initialize the queue through which natives can be invoked at the end of a server frame.
+  deferred_native_queue_.reset(new DeferredNativeQueue);
+
+  // Initialize the native result cache. This is an optional feature, so continue when the file
+  // listing the cacheable natives does not exist.
+  native_result_cache_ = NativeResultCache::FromFile(path.Append(kCachedNativesFile));
+  if (native_result_cache_) {
+    // Natives are registered when the AMX files load, at which point their Ids become known.
+    native_function_manager_->set_registration_observer(
+        [this](const std::string& function_name, int native_id) {
+      native_result_cache_->RegisterNative(function_name, native_id);
+    });
+  } else {
+    LOG(INFO) << "Native results will not be cached: unable to load " << kCachedNativesFile;
+  }
+
+  // Initialize the player state mirror. Mirroring will be enabled by JavaScript when desired.
+  player_state_mirror_.reset(new PlayerStateMirror);
+  player_state_native_ids_.resize(PLAYER_STATE_NATIVE_COUNT, NativeFunctionManager::kInvalidNativeId);
+
   // Initialize the callback manager, which can call public functions in all available AMX files.
   callback_manager_.reset(new CallbackManager);
 
@@ -71,6 +125,13 @@ PluginController::PluginController(const base::FilePath& path) {
     return;
   }
 
+  // Pawn may have changed state since JavaScript last ran, so cached native results cannot be
+  // trusted when Pawn calls in to JavaScript through one of the provided natives.
+  native_parser_->set_call_observer([this]() {
+    if (native_result_cache_)
+      native_result_cache_->InvalidateAll();
+  });
+
   // If the test runner is driving this invocation, announce availability of the gamemode.
   if (!pAMXFunctions)
     plugin_delegate_->OnGamemodeLoaded();
@@ -98,12 +159,10 @@ void PluginController::Output(const std::string& message) const {
 }
 
 bool PluginController::IsPlayerMinimized(int player_id, double current_time) const {
-  const auto iter = player_update_time_.find(player_id);
-  if (iter == player_update_time_.end())
+  const double last_update = player_state_mirror_->GetLastUpdateTime(player_id);
+  if (last_update < 0)
     return true;  // no updates have ever been received for the |player_id|
 
-  const double last_update = iter->second;
-
   return (current_time - last_update) >= kIdleThresholdMs;
 }
 
@@ -111,15 +170,109 @@ bool PluginController::FunctionExists(const std::string& function_name) const {
   return native_function_manager_->FunctionExists(function_name);
 }
 
-int PluginController::CallFunction(const std::string& function_name, const char* format, void** arguments) {
-  if (function_name.size() > 2 && function_name[0] == 'O' && function_name[1] == 'n')
-    return callback_manager_->CallPublic(function_name, format, arguments);
+int PluginController::GetNativeId(const std::string& function_name) {
+  return native_function_manager_->GetNativeId(function_name);
+}
+
+bool PluginController::IsValidNativeId(int native_id) const {
+  return native_function_manager_->IsValidNativeId(native_id);
+}
+
+size_t PluginController::GetArraySizeOffset(int native_id, size_t parameter_index) const {
+  return native_function_manager_->GetArraySizeOffset(native_id, parameter_index);
+}
+
+int PluginController::CallFunction(const std::string& function_name, const char* format,
+                                   void** arguments, bool* success) {
+  if (function_name.size() > 2 && function_name[0] == 'O' && function_name[1] == 'n') {
+    if (native_result_cache_)
+      native_result_cache_->InvalidateAll();
+
+    return callback_manager_->CallPublic(function_name, format, arguments, success);
+  }
+
+  const int native_id = GetNativeId(function_name);
+  if (native_id == NativeFunctionManager::kInvalidNativeId) {
+    LOG(WARNING) << "Attempting to invoke unknown Pawn native " << function_name << ". Ignoring.";
+    if (success)
+      *success = false;
+
+    return -1;
+  }
+
+  return CallFunction(native_id, format, arguments, success);
+}
+
+bool PluginController::CallPublicBatch(const std::string& function_name, const char* format,
+                                       void** arguments, size_t count, int32_t* results) {
+  if (native_result_cache_)
+    native_result_cache_->InvalidateAll();
+
+  return callback_manager_->CallPublicBatch(function_name, format, arguments, count, results);
+}
+
+int PluginController::CallFunction(int native_id, const char* format, void** arguments,
+                                   bool* success) {
+  if (!native_result_cache_)
+    return native_function_manager_->CallFunction(native_id, format, arguments, success);
+
+  int result = 0;
+  if (native_result_cache_->IsCacheable(native_id)) {
+    if (native_result_cache_->Lookup(native_id, format, arguments, &result)) {
+      if (success)
+        *success = true;
+
+      return result;
+    }
+
+    bool called = false;
+    result = native_function_manager_->CallFunction(native_id, format, arguments, &called);
+    if (called)
+      native_result_cache_->Store(native_id, format, arguments, result);
+
+    if (success)
+      *success = called;
+
+    return result;
+  }
+
+  // Natives that aren't cacheable are considered to be mutating. Invalidate the cached results
+  // that share their target, which, by SA-MP convention, is the first argument. Natives without
+  // an integral target may change anything, so all cached results will be invalidated for those.
+  if (format && format[0] == 'i')
+    native_result_cache_->Invalidate(*reinterpret_cast<int32_t*>(arguments[0]));
+  else
+    native_result_cache_->InvalidateAll();
+
+  return native_function_manager_->CallFunction(native_id, format, arguments, success);
+}
+
+bool PluginController::CallFunctionDeferred(int native_id, const char* format, void** arguments,
+                                            bool supersede) {
+  return deferred_native_queue_->Enqueue(native_id, format, arguments, supersede);
+}
 
-  return native_function_manager_->CallFunction(function_name, format, arguments);
+void PluginController::RegisterSharedBuffer(const std::string& name, AMX* amx, int32_t* data,
+                                            size_t size) {
+  if (shared_buffers_.Register(name, amx, data, size))
+    plugin_delegate_->OnSharedBufferRemoved(name);
 }
 
 void PluginController::OnServerFrame() {
+  if (native_result_cache_)
+    native_result_cache_->InvalidateAll();
+
   plugin_delegate_->OnServerFrame();
+
+  // Execute the native calls that were deferred during this frame, or in between frames.
+  deferred_native_queue_->Flush([this](int native_id, const char* format, void** arguments) {
+    return CallFunction(native_id, format, arguments);
+  });
+}
+
+void PluginController::OnAmxUnloaded(AMX* amx) {
+  for (const std::string& name : shared_buffers_.RemoveAll(amx))
+    plugin_delegate_->OnSharedBufferRemoved(name);
 }
 
 void PluginController::DidRunTests(unsigned int total_tests, unsigned int failed_tests) {
@@ -134,13 +287,69 @@ void PluginController::OnGamemodeChanged(AMX* gamemode) {
 }
 
 void PluginController::OnPlayerUpdate(int player_id) {
-  player_update_time_[player_id] = base::monotonicallyIncreasingTime();
+  if (native_result_cache_)
+    native_result_cache_->Invalidate(player_id);
+
+  player_state_mirror_->OnPlayerUpdate(
+      player_id, base::monotonicallyIncreasingTime(),
+      [this](int updated_player_id, PlayerStateMirror::PlayerState* state) {
+    ReadPlayerState(updated_player_id, state);
+  });
 }
 
-bool PluginController::OnCallbackIntercepted(const std::string& callback,
-                                             const Arguments& arguments,
-                                             bool deferred) {
-  return plugin_delegate_->OnCallbackIntercepted(callback, arguments, deferred);
+bool PluginController::OnCallbackIntercepted(const Callback& callback,
+                                             const Arguments& arguments) {
+  if (native_result_cache_)
+    native_result_cache_->InvalidateAll();
+
+  return plugin_delegate_->OnCallbackIntercepted(callback, arguments);
+}
+
+void PluginController::OnPawnExecuted() {
+  if (native_result_cache_)
+    native_result_cache_->InvalidateAll();
+}
+
+void PluginController::ReadPlayerState(int player_id, PlayerStateMirror::PlayerState* state) {
+  // Natives only become available once they've been registered, so resolve them lazily.
+  for (size_t index = 0; index < PLAYER_STATE_NATIVE_COUNT; ++index) {
+    if (player_state_native_ids_[index] == NativeFunctionManager::kInvalidNativeId)
+      player_state_native_ids_[index] = GetNativeId(kPlayerStateNatives[index]);
+  }
+
+  auto call = [&](PlayerStateNative native, const char* format, void** arguments) {
+    const int native_id = player_state_native_ids_[native];
+    if (native_id == NativeFunctionManager::kInvalidNativeId)
+      return 0;
+
+    return CallFunction(native_id, format, arguments);
+  };
+
+  float* floats = state->floats;
+  int32_t* integers = state->integers;
+
+  void* position_arguments[] = {
+    &player_id,
+    &floats[PlayerStateMirror::FLOAT_FIELD_POSITION_X],
+    &floats[PlayerStateMirror::FLOAT_FIELD_POSITION_Y],
+    &floats[PlayerStateMirror::FLOAT_FIELD_POSITION_Z] };
+  call(PLAYER_STATE_NATIVE_POSITION, "irrr", position_arguments);
+
+  void* health_arguments[] = { &player_id, &floats[PlayerStateMirror::FLOAT_FIELD_HEALTH] };
+  call(PLAYER_STATE_NATIVE_HEALTH, "ir", health_arguments);
+
+  void* armour_arguments[] = { &player_id, &floats[PlayerStateMirror::FLOAT_FIELD_ARMOUR] };
+  call(PLAYER_STATE_NATIVE_ARMOUR, "ir", armour_arguments);
+
+  void* player_arguments[] = { &player_id };
+  integers[PlayerStateMirror::INTEGER_FIELD_STATE] =
+      call(PLAYER_STATE_NATIVE_STATE, "i", player_arguments);
+  integers[PlayerStateMirror::INTEGER_FIELD_VEHICLE_ID] =
+      call(PLAYER_STATE_NATIVE_VEHICLE_ID, "i", player_arguments);
+  integers[PlayerStateMirror::INTEGER_FIELD_INTERIOR] =
+      call(PLAYER_STATE_NATIVE_INTERIOR, "i", player_arguments);
+  integers[PlayerStateMirror::INTEGER_FIELD_VIRTUAL_WORLD] =
+      call(PLAYER_STATE_NATIVE_VIRTUAL_WORLD, "i", player_arguments);
 }
 
 }  // namespace plugin
@@ -6,9 +6,11 @@
 #define PLAYGROUND_PLUGIN_PLUGIN_CONTROLLER_H_
 
 #include <memory>
-#include <unordered_map>
+#include <vector>
 
 #include "plugin/callback_hook.h"
+#include "plugin/player_state_mirror.h"
+#include "plugin/shared_buffer_registry.h"
 
 typedef struct tagAMX_NATIVE_INFO AMX_NATIVE_INFO;
 
@@ -22,8 +24,10 @@ class Arguments;
 struct Callback;
 class CallbackManager;
 class CallbackParser;
+class DeferredNativeQueue;
 class NativeFunctionManager;
 class NativeParser;
+class NativeResultCache;
 class PluginDelegate;
 
 // The plugin controller is responsible for any communication with the SA-MP server and the
@@ -46,16 +50,54 @@ class PluginController : public CallbackHook::Delegate {
   // Returns whether a function named |function_name| exists in the Pawn runtime.
   bool FunctionExists(const std::string& function_name) const;
   
+  // Returns the Id of the native named |function_name|, to be used with CallFunction(). Natives
+  // only become available once they have been registered, so callers are expected to try again
+  // later when -1 is returned.
+  int GetNativeId(const std::string& function_name);
+
+  // Returns whether |native_id| identifies a native that can be called through CallFunction().
+  bool IsValidNativeId(int native_id) const;
+
+  // Returns the offset between the array parameter at |parameter_index| of the native identified
+  // by |native_id| and the parameter that contains its size.
+  size_t GetArraySizeOffset(int native_id, size_t parameter_index) const;
+
   // Calls the Pawn function named |function_name|, having |arguments| structured like |format|. The
   // return value of the function will be returned, whereas any arguments passed by reference will
   // have their values updated accordingly. This method does not rely on having a live gamemode.
+  // Functions may return -1, which is also returned on failure, so |success|, when given, will be
+  // set to whether the function could be called.
   int CallFunction(const std::string& function_name,
                    const char* format = nullptr,
-                   void** arguments = nullptr);
+                   void** arguments = nullptr,
+                   bool* success = nullptr);
+
+  // Calls the Pawn public function named |function_name| |count| times, each with the next
+  // strlen(|format|) entries in |arguments|, writing the return values to |results|. Returns
+  // whether the calls could be made. This avoids looking up the function for each invocation.
+  bool CallPublicBatch(const std::string& function_name, const char* format, void** arguments,
+                       size_t count, int32_t* results);
+
+  // Calls the native function identified by |native_id|, as obtained through GetNativeId(). This
+  // avoids having to look up the function by its name for each invocation.
+  int CallFunction(int native_id, const char* format = nullptr, void** arguments = nullptr,
+                   bool* success = nullptr);
+
+  // Queues a call to the native identified by |native_id|, which will be executed at the end of the
+  // current server frame. Only [ifs] arguments are supported, as no values will be returned. When
+  // |supersede| is set, an earlier superseding call to the native on the same target is dropped.
+  bool CallFunctionDeferred(int native_id, const char* format, void** arguments, bool supersede);
+
+  // Shares the buffer of |size| cells at |data| in the |amx| with JavaScript as |name|. Views on a
+  // buffer previously registered with the same name will be detached.
+  void RegisterSharedBuffer(const std::string& name, AMX* amx, int32_t* data, size_t size);
 
   // Called when the SA-MP server starts delivering a frame on the main thread.
   void OnServerFrame();
 
+  // Called when the |amx| is being unloaded by the SA-MP server. Buffers it shared will be removed.
+  void OnAmxUnloaded(AMX* amx);
+
   // To be called when tests have finished executing in the JavaScript gamemode. The test runner
   // is only interested in running the tests, not the rest of the script.
   void DidRunTests(unsigned int total_tests, unsigned int failed_tests);
@@ -63,13 +105,17 @@ class PluginController : public CallbackHook::Delegate {
   // CallbackHook::Delegate implementation.
   void OnGamemodeChanged(AMX* gamemode) override;
   void OnPlayerUpdate(int player_id) override;
-  bool OnCallbackIntercepted(const std::string& callback,
-                             const Arguments& arguments,
-                             bool deferred) override;
+  bool OnCallbackIntercepted(const Callback& callback, const Arguments& arguments) override;
+  void OnPawnExecuted() override;
 
   NativeParser* native_parser() { return native_parser_.get(); }
+  PlayerStateMirror* player_state_mirror() { return player_state_mirror_.get(); }
+  const SharedBufferRegistry& shared_buffers() const { return shared_buffers_; }
 
  private:
+  // Reads the state of |player_id| that's to be mirrored in to |state| by calling the natives.
+  void ReadPlayerState(int player_id, PlayerStateMirror::PlayerState* state);
+
   // The hook through which we intercept callbacks issued by the SA-MP server, as well those
   // that are issued through plugins loaded in the SA-MP server.
   std::unique_ptr<CallbackHook> callback_hook_;
@@ -84,16 +130,29 @@ class PluginController : public CallbackHook::Delegate {
   // in the gamemode, as well as providing the ability to invoke them when necessary.
   std::unique_ptr<NativeFunctionManager> native_function_manager_;
 
+  // Queue of native function calls that will be executed at the end of the server frame.
+  std::unique_ptr<DeferredNativeQueue> deferred_native_queue_;
+
   // The native function parser that loads the file of functions supported by the plugin.
   std::unique_ptr<NativeParser> native_parser_;
 
+  // Cache for the results of read-only native functions within a single server frame. Optional.
+  std::unique_ptr<NativeResultCache> native_result_cache_;
+
+  // Mirror of the players' state, which tracks when they last sent an update as well. Must outlive
+  // the |plugin_delegate_|, as JavaScript holds views on the mirrored state.
+  std::unique_ptr<PlayerStateMirror> player_state_mirror_;
+
+  // Ids of the natives through which the mirrored player state will be read.
+  std::vector<int> player_state_native_ids_;
+
+  // Buffers that have been shared by Pawn. Their memory is owned by the AMX that shared them.
+  SharedBufferRegistry shared_buffers_;
+
   // The plugin delegate is the higher-level interface for which we translate SA-MP specific
   // concepts to much more generic ones. No traces of the Pawn runtime should be exposed at
   // this layer.
   std::unique_ptr<PluginDelegate> plugin_delegate_;
-
-  // Stores a mapping from a player Id to the time they last sent an update.
-  std::unordered_map<int, double> player_update_time_;
 };
 
 }  // plugin
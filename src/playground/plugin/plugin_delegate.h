@@ -25,7 +25,7 @@ class PluginDelegate {
   // Called when a callback has been intercepted. The |callback| contains information about the
   // event that has been invoked, the |arguments| contain the actual context. Returning true
   // from this method will block the callback from being invoked in the Pawn runtime.
-  virtual bool OnCallbackIntercepted(const std::string& callback, const Arguments& arguments, bool deferred) = 0;
+  virtual bool OnCallbackIntercepted(const Callback& callback, const Arguments& arguments) = 0;
 
   // Called when the gamemode has been loaded. This is the appropriate time to initialize the v8
   // runtime, as callbacks will start to be invoked shortly after this.
@@ -34,6 +34,10 @@ class PluginDelegate {
   // Called when the server begins a new frame on the main thread. Beyond intercepted callbacks,
   // this is the only time where it's OK to invoke native functions.
   virtual void OnServerFrame() = 0;
+
+  // Called when the buffer shared by Pawn as |name| is no longer valid, after which its memory
+  // must not be accessed anymore.
+  virtual void OnSharedBufferRemoved(const std::string& name) = 0;
 };
 
 }  // namespace plugin
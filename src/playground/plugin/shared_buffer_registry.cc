@@ -0,0 +1,70 @@
+// Copyright 2020 Las Venturas Playground. All rights reserved.
+// Use of this source code is governed by the MIT license, a copy of which can
+// be found in the LICENSE file.
+
+#include "plugin/shared_buffer_registry.h"
+
+#include "plugin/sdk/amx.h"
+
+namespace plugin {
+
+SharedBufferRegistry::SharedBufferRegistry() = default;
+
+SharedBufferRegistry::~SharedBufferRegistry() = default;
+
+// static
+int32_t* SharedBufferRegistry::GetGlobalArray(AMX* amx, int32_t address, int32_t size) {
+  if (!amx || !amx->base || address < 0 || size <= 0 || address % sizeof(cell))
+    return nullptr;
+
+  const AMX_HEADER* header = reinterpret_cast<const AMX_HEADER*>(amx->base);
+
+  // The data section spans from the start of the data block until the start of the heap.
+  const int64_t data_section_size = static_cast<int64_t>(header->hea) - header->dat;
+  const int64_t end = static_cast<int64_t>(address) + static_cast<int64_t>(size) * sizeof(cell);
+
+  if (end > data_section_size)
+    return nullptr;
+
+  unsigned char* data = amx->data ? amx->data : amx->base + header->dat;
+  return reinterpret_cast<int32_t*>(data + address);
+}
+
+bool SharedBufferRegistry::Register(const std::string& name, AMX* amx, int32_t* data,
+                                    size_t size) {
+  auto iter = buffers_.find(name);
+  if (iter != buffers_.end()) {
+    iter->second = SharedBuffer { amx, data, size };
+    return true;
+  }
+
+  buffers_.emplace(name, SharedBuffer { amx, data, size });
+  return false;
+}
+
+const SharedBufferRegistry::SharedBuffer* SharedBufferRegistry::Find(
+    const std::string& name) const {
+  auto iter = buffers_.find(name);
+  if (iter == buffers_.end())
+    return nullptr;
+
+  return &iter->second;
+}
+
+std::vector<std::string> SharedBufferRegistry::RemoveAll(AMX* amx) {
+  std::vector<std::string> removed;
+
+  auto iter = buffers_.begin();
+  while (iter != buffers_.end()) {
+    if (iter->second.amx == amx) {
+      removed.push_back(iter->first);
+      iter = buffers_.erase(iter);
+    } else {
+      iter++;
+    }
+  }
+
+  return removed;
+}
+
+}  // namespace plugin
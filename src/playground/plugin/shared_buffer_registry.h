@@ -0,0 +1,64 @@
+// Copyright 2020 Las Venturas Playground. All rights reserved.
+// Use of this source code is governed by the MIT license, a copy of which can
+// be found in the LICENSE file.
+
+#ifndef PLAYGROUND_PLUGIN_SHARED_BUFFER_REGISTRY_H_
+#define PLAYGROUND_PLUGIN_SHARED_BUFFER_REGISTRY_H_
+
+#include <stdint.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "base/macros.h"
+
+typedef struct tagAMX AMX;
+
+namespace plugin {
+
+// Registry of the named buffers that Pawn shares with JavaScript. A shared buffer is a global array
+// in the data section of an AMX, which JavaScript can access as an Int32Array over the same memory.
+// Neither side has to copy data or call the other to exchange state through the buffer.
+//
+// The memory of a shared buffer is owned by its AMX, so the buffer must be removed, and any views
+// on it be detached, before the AMX gets unloaded.
+class SharedBufferRegistry {
+ public:
+  struct SharedBuffer {
+    AMX* amx;
+
+    // Physical address of the first cell of the buffer, and the number of cells in it.
+    int32_t* data;
+    size_t size;
+  };
+
+  SharedBufferRegistry();
+  ~SharedBufferRegistry();
+
+  // Returns the physical address of the |size| cells at the Pawn |address| in the |amx|, or a
+  // nullptr when they're not entirely within the AMX's data section. Addresses on the heap or the
+  // stack are rejected, as their memory does not remain valid.
+  static int32_t* GetGlobalArray(AMX* amx, int32_t address, int32_t size);
+
+  // Registers the buffer of |size| cells at |data| in the |amx| as |name|, replacing any buffer
+  // previously registered with that name. Returns whether a buffer has been replaced.
+  bool Register(const std::string& name, AMX* amx, int32_t* data, size_t size);
+
+  // Returns the buffer that has been registered as |name|, or a nullptr when there is none.
+  const SharedBuffer* Find(const std::string& name) const;
+
+  // Removes all buffers that have been registered by the |amx|. Returns their names.
+  std::vector<std::string> RemoveAll(AMX* amx);
+
+  // Returns the number of buffers that have been registered.
+  size_t size() const { return buffers_.size(); }
+
+ private:
+  std::unordered_map<std::string, SharedBuffer> buffers_;
+
+  DISALLOW_COPY_AND_ASSIGN(SharedBufferRegistry);
+};
+
+}  // namespace plugin
+
+#endif  // PLAYGROUND_PLUGIN_SHARED_BUFFER_REGISTRY_H_
@@ -0,0 +1,80 @@
+// Copyright 2020 Las Venturas Playground. All rights reserved.
+// Use of this source code is governed by the MIT license, a copy of which can
+// be found in the LICENSE file.
+
+#include "plugin/shared_buffer_registry.h"
+
+#include "gtest/gtest.h"
+#include "plugin/sdk/amx.h"
+
+namespace plugin {
+
+TEST(SharedBufferRegistryTest, RegisterAndRemove) {
+  SharedBufferRegistry registry;
+
+  AMX* gamemode = reinterpret_cast<AMX*>(0x1000);
+  AMX* filterscript = reinterpret_cast<AMX*>(0x2000);
+
+  int32_t flags[16] = { 0 };
+  int32_t accounts[64] = { 0 };
+  int32_t settings[8] = { 0 };
+
+  EXPECT_FALSE(registry.Register("flags", gamemode, flags, 16));
+  EXPECT_FALSE(registry.Register("accounts", gamemode, accounts, 32));
+  EXPECT_FALSE(registry.Register("settings", filterscript, settings, 8));
+  EXPECT_EQ(3u, registry.size());
+
+  // Registering a buffer with the same name replaces the existing one.
+  EXPECT_TRUE(registry.Register("accounts", gamemode, accounts, 64));
+  EXPECT_EQ(3u, registry.size());
+
+  const SharedBufferRegistry::SharedBuffer* buffer = registry.Find("accounts");
+  ASSERT_TRUE(buffer);
+  EXPECT_EQ(accounts, buffer->data);
+  EXPECT_EQ(64u, buffer->size);
+
+  EXPECT_FALSE(registry.Find("invalid"));
+
+  std::vector<std::string> removed = registry.RemoveAll(filterscript);
+  ASSERT_EQ(1u, removed.size());
+  EXPECT_EQ("settings", removed[0]);
+
+  EXPECT_FALSE(registry.Find("settings"));
+  EXPECT_TRUE(registry.Find("flags"));
+  EXPECT_EQ(2u, registry.size());
+}
+
+TEST(SharedBufferRegistryTest, GetGlobalArray) {
+  // Memory of an AMX with a data section of 16 cells, followed by the heap and the stack.
+  std::vector<cell> memory(64, 0);
+
+  AMX_HEADER* header = reinterpret_cast<AMX_HEADER*>(memory.data());
+  header->dat = 16 * sizeof(cell);
+  header->hea = header->dat + 16 * sizeof(cell);
+  header->stp = header->dat + 48 * sizeof(cell);
+
+  AMX amx = {};
+  amx.base = reinterpret_cast<unsigned char*>(memory.data());
+  amx.hea = 16 * sizeof(cell);
+  amx.stk = 40 * sizeof(cell);
+  amx.stp = 48 * sizeof(cell);
+
+  cell* data_section = memory.data() + 16;
+
+  EXPECT_EQ(data_section, SharedBufferRegistry::GetGlobalArray(&amx, 0, 16));
+  EXPECT_EQ(data_section + 4, SharedBufferRegistry::GetGlobalArray(&amx, 4 * sizeof(cell), 12));
+
+  // Buffers that don't fit, have no cells, or aren't aligned are rejected.
+  EXPECT_FALSE(SharedBufferRegistry::GetGlobalArray(&amx, 0, 17));
+  EXPECT_FALSE(SharedBufferRegistry::GetGlobalArray(&amx, 0, 0));
+  EXPECT_FALSE(SharedBufferRegistry::GetGlobalArray(&amx, -4, 4));
+  EXPECT_FALSE(SharedBufferRegistry::GetGlobalArray(&amx, 2, 4));
+
+  // Local arrays live on the stack, and must be rejected.
+  EXPECT_FALSE(SharedBufferRegistry::GetGlobalArray(&amx, amx.stk, 4));
+
+  // Ranges spanning the data section and the heap must be rejected as well.
+  EXPECT_FALSE(SharedBufferRegistry::GetGlobalArray(&amx, 12 * sizeof(cell), 8));
+}
+
+}  // namespace plugin
@@ -0,0 +1,194 @@
+// Copyright 2020 Las Venturas Playground. All rights reserved.
+// Use of this source code is governed by the MIT license, a copy of which can
+// be found in the LICENSE file.
+
+#include "plugin/string_marshalling.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define PLAYGROUND_STRING_MARSHALLING_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace plugin {
+
+namespace {
+
+// Values of the first cell above this indicate that the string is packed (UNPACKEDMAX).
+const uint32_t kUnpackedMax = 0x00FFFFFF;
+
+#if defined(PLAYGROUND_STRING_MARSHALLING_SSE2)
+// Returns whether |pointer| is aligned on a sixteen byte boundary. Aligned loads never cross a page
+// boundary, which makes it safe to read beyond the end of a string as long as it ends in the vector.
+bool IsAligned(const void* pointer) {
+  return (reinterpret_cast<uintptr_t>(pointer) & 15) == 0;
+}
+
+// Returns whether any of the cells in |cells| is zero.
+bool HasZeroCell(__m128i cells) {
+  return _mm_movemask_epi8(_mm_cmpeq_epi32(cells, _mm_setzero_si128())) != 0;
+}
+#endif
+
+}  // namespace
+
+bool IsPackedString(const int32_t* source) {
+  return static_cast<uint32_t>(*source) > kUnpackedMax;
+}
+
+size_t GetStringLength(const int32_t* source) {
+  size_t length = 0;
+
+  if (IsPackedString(source)) {
+    for (;; ++source) {
+      const uint32_t value = static_cast<uint32_t>(*source);
+      for (int shift = 24; shift >= 0; shift -= 8) {
+        if (!((value >> shift) & 0xFF))
+          return length;
+
+        ++length;
+      }
+    }
+  }
+
+#if defined(PLAYGROUND_STRING_MARSHALLING_SSE2)
+  while (!IsAligned(source + length)) {
+    if (!source[length])
+      return length;
+
+    ++length;
+  }
+
+  for (;; length += 4) {
+    const __m128i cells = _mm_load_si128(reinterpret_cast<const __m128i*>(source + length));
+    if (HasZeroCell(cells))
+      break;
+  }
+#endif
+
+  while (source[length])
+    ++length;
+
+  return length;
+}
+
+size_t NarrowString(const int32_t* source, char* destination, size_t size) {
+  if (!size)
+    return 0;
+
+  const size_t capacity = size - 1;
+  size_t length = 0;
+
+  if (IsPackedString(source)) {
+    for (; length < capacity; ++length) {
+      const uint32_t value = static_cast<uint32_t>(source[length / 4]);
+      const char character = static_cast<char>(value >> (24 - (length % 4) * 8));
+      if (!character)
+        break;
+
+      destination[length] = character;
+    }
+
+    destination[length] = 0;
+    return length;
+  }
+
+#if defined(PLAYGROUND_STRING_MARSHALLING_SSE2)
+  while (length < capacity && source[length] && !IsAligned(source + length)) {
+    destination[length] = static_cast<char>(source[length]);
+    ++length;
+  }
+
+  if (IsAligned(source + length)) {
+    const __m128i mask = _mm_set1_epi32(0xFF);
+
+    // Narrow sixteen cells at a time, for as long as none of them terminates the string. Each of the
+    // vectors is checked before loading the next one, as the string may end in it. Cells will be
+    // truncated to their least significant byte by masking them before packing them together.
+    for (; length + 16 <= capacity; length += 16) {
+      const __m128i* cells = reinterpret_cast<const __m128i*>(source + length);
+
+      const __m128i first = _mm_load_si128(cells + 0);
+      if (HasZeroCell(first))
+        break;
+
+      const __m128i second = _mm_load_si128(cells + 1);
+      if (HasZeroCell(second))
+        break;
+
+      const __m128i third = _mm_load_si128(cells + 2);
+      if (HasZeroCell(third))
+        break;
+
+      const __m128i fourth = _mm_load_si128(cells + 3);
+      if (HasZeroCell(fourth))
+        break;
+
+      const __m128i low = _mm_packs_epi32(_mm_and_si128(first, mask), _mm_and_si128(second, mask));
+      const __m128i high = _mm_packs_epi32(_mm_and_si128(third, mask), _mm_and_si128(fourth, mask));
+
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(destination + length),
+                       _mm_packus_epi16(low, high));
+    }
+  }
+#endif
+
+  for (; length < capacity && source[length]; ++length)
+    destination[length] = static_cast<char>(source[length]);
+
+  destination[length] = 0;
+  return length;
+}
+
+void WidenString(const char* source, size_t length, int32_t* destination) {
+  size_t index = 0;
+
+#if defined(PLAYGROUND_STRING_MARSHALLING_SSE2)
+  const __m128i zero = _mm_setzero_si128();
+
+  // Widen sixteen characters at a time. Each of the bytes is interleaved with its sign mask twice,
+  // first to sixteen and then to thirty-two bits, which sign extends them to a full cell.
+  for (; index + 16 <= length; index += 16) {
+    const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + index));
+    const __m128i sign = _mm_cmpgt_epi8(zero, bytes);
+
+    const __m128i low = _mm_unpacklo_epi8(bytes, sign);
+    const __m128i high = _mm_unpackhi_epi8(bytes, sign);
+
+    const __m128i low_sign = _mm_srai_epi16(low, 15);
+    const __m128i high_sign = _mm_srai_epi16(high, 15);
+
+    __m128i* cells = reinterpret_cast<__m128i*>(destination + index);
+    _mm_storeu_si128(cells + 0, _mm_unpacklo_epi16(low, low_sign));
+    _mm_storeu_si128(cells + 1, _mm_unpackhi_epi16(low, low_sign));
+    _mm_storeu_si128(cells + 2, _mm_unpacklo_epi16(high, high_sign));
+    _mm_storeu_si128(cells + 3, _mm_unpackhi_epi16(high, high_sign));
+  }
+#endif
+
+  for (; index < length; ++index)
+    destination[index] = static_cast<int32_t>(static_cast<signed char>(source[index]));
+
+  destination[length] = 0;
+}
+
+bool IsAsciiString(const char* string, size_t length) {
+  size_t index = 0;
+
+#if defined(PLAYGROUND_STRING_MARSHALLING_SSE2)
+  __m128i bits = _mm_setzero_si128();
+  for (; index + 16 <= length; index += 16)
+    bits = _mm_or_si128(bits, _mm_loadu_si128(reinterpret_cast<const __m128i*>(string + index)));
+
+  // The most significant bit of each byte is only set for characters outside of the ASCII range.
+  if (_mm_movemask_epi8(bits))
+    return false;
+#endif
+
+  unsigned char tail_bits = 0;
+  for (; index < length; ++index)
+    tail_bits |= static_cast<unsigned char>(string[index]);
+
+  return !(tail_bits & 0x80);
+}
+
+}  // namespace plugin
@@ -0,0 +1,41 @@
+// Copyright 2020 Las Venturas Playground. All rights reserved.
+// Use of this source code is governed by the MIT license, a copy of which can
+// be found in the LICENSE file.
+
+#ifndef PLAYGROUND_PLUGIN_STRING_MARSHALLING_H_
+#define PLAYGROUND_PLUGIN_STRING_MARSHALLING_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace plugin {
+
+// Routines for converting strings between C++ and the Pawn runtime, where each character of an
+// unpacked string is stored in a cell, and packed strings store four characters per cell with the
+// first character in the most significant byte. Their behaviour matches amx_SetString(),
+// amx_StrLen() and amx_GetString() with |use_wchar| set to false, but unpacked strings will be
+// processed sixteen characters at a time using SSE2 when available.
+
+// Returns whether the string at |source| is a packed string.
+bool IsPackedString(const int32_t* source);
+
+// Returns the length of the string at |source|, in characters.
+size_t GetStringLength(const int32_t* source);
+
+// Narrows the string at |source| in to |destination|, which is able to hold |size| bytes. At most
+// |size| - 1 characters will be written, followed by a zero byte. Returns the number of characters
+// that were written, which excludes the zero byte. Nothing will be written when |size| is zero.
+size_t NarrowString(const int32_t* source, char* destination, size_t size);
+
+// Widens the |length| characters in |source| to cells in |destination|, followed by a zero cell,
+// which is what amx_SetString() does for unpacked strings. Characters will be sign extended. The
+// |destination| must be able to hold at least |length| + 1 cells.
+void WidenString(const char* source, size_t length, int32_t* destination);
+
+// Returns whether all |length| characters in |string| are ASCII characters, in which case the
+// string can be interpreted as either UTF-8 or Latin-1 without having to decode it.
+bool IsAsciiString(const char* string, size_t length);
+
+}  // namespace plugin
+
+#endif  // PLAYGROUND_PLUGIN_STRING_MARSHALLING_H_
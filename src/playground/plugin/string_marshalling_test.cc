@@ -0,0 +1,139 @@
+// Copyright 2020 Las Venturas Playground. All rights reserved.
+// Use of this source code is governed by the MIT license, a copy of which can
+// be found in the LICENSE file.
+
+#include "plugin/string_marshalling.h"
+
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace plugin {
+
+namespace {
+
+// Scalar implementations of amx_StrLen() and amx_GetString() for unpacked strings, as found in the
+// Pawn runtime, against which the results of the vectorised routines are compared.
+size_t ReferenceStringLength(const int32_t* source) {
+  size_t length = 0;
+  while (source[length] != 0)
+    ++length;
+
+  return length;
+}
+
+size_t ReferenceNarrowString(const int32_t* source, char* destination, size_t size) {
+  size_t length = 0;
+  while (*source != 0 && length < size - 1)
+    destination[length++] = static_cast<char>(*source++);
+
+  destination[length] = '\0';
+  return length;
+}
+
+// Builds an unpacked string of |length| characters at |offset| cells in to |cells|, to exercise
+// the routines with differently aligned strings.
+int32_t* BuildUnpackedString(std::vector<int32_t>* cells, size_t offset, size_t length) {
+  cells->assign(offset + length + 32, 0x7F7F7F7F);
+
+  for (size_t index = 0; index < length; ++index) {
+    // Include characters outside of the ASCII range, and cells that exceed a single byte.
+    int32_t value = 'a' + index % 26;
+    if (index % 7 == 3)
+      value = 0xE9;
+    else if (index % 11 == 5)
+      value = 0x141;
+
+    (*cells)[offset + index] = value;
+  }
+
+  (*cells)[offset + length] = 0;
+  return cells->data() + offset;
+}
+
+}  // namespace
+
+TEST(StringMarshallingTest, UnpackedStrings) {
+  std::vector<int32_t> cells;
+  std::vector<char> expected, actual;
+
+  for (size_t offset = 0; offset < 4; ++offset) {
+    for (size_t length = 0; length < 70; ++length) {
+      const int32_t* source = BuildUnpackedString(&cells, offset, length);
+
+      EXPECT_FALSE(IsPackedString(source) && length > 0);
+      EXPECT_EQ(ReferenceStringLength(source), GetStringLength(source));
+
+      // Narrow the string in to buffers that are both smaller and larger than the string.
+      for (size_t size = 1; size < length + 4; size += 5) {
+        expected.assign(size, 'x');
+        actual.assign(size, 'x');
+
+        const size_t expected_length = ReferenceNarrowString(source, expected.data(), size);
+        EXPECT_EQ(expected_length, NarrowString(source, actual.data(), size));
+        EXPECT_EQ(expected, actual) << "offset: " << offset << ", length: " << length;
+      }
+    }
+  }
+}
+
+TEST(StringMarshallingTest, PackedStrings) {
+  // "Hello, packed world" packed in to cells, with the first character in the highest byte.
+  const std::string text = "Hello, packed world";
+
+  std::vector<int32_t> cells((text.size() + 4) / 4, 0);
+  for (size_t index = 0; index < text.size(); ++index)
+    cells[index / 4] |= static_cast<int32_t>(text[index]) << (24 - (index % 4) * 8);
+
+  EXPECT_TRUE(IsPackedString(cells.data()));
+  EXPECT_EQ(text.size(), GetStringLength(cells.data()));
+
+  char buffer[32];
+  EXPECT_EQ(text.size(), NarrowString(cells.data(), buffer, sizeof(buffer)));
+  EXPECT_EQ(text, buffer);
+
+  EXPECT_EQ(5u, NarrowString(cells.data(), buffer, 6));
+  EXPECT_EQ("Hello", std::string(buffer));
+}
+
+TEST(StringMarshallingTest, WidenString) {
+  std::string text;
+  std::vector<int32_t> cells;
+
+  for (size_t length = 0; length < 70; ++length) {
+    cells.assign(length + 1, -1);
+    WidenString(text.c_str(), length, cells.data());
+
+    for (size_t index = 0; index < length; ++index)
+      ASSERT_EQ(static_cast<int32_t>(static_cast<signed char>(text[index])), cells[index]);
+
+    EXPECT_EQ(0, cells[length]);
+
+    // Widening and narrowing the string again must result in the same string. (The first character
+    // is in the ASCII range, as the string would otherwise be considered to be packed.)
+    std::vector<char> narrowed(length + 1);
+    EXPECT_EQ(length, NarrowString(cells.data(), narrowed.data(), narrowed.size()));
+    EXPECT_EQ(text, std::string(narrowed.data()));
+
+    text.push_back(static_cast<char>(length % 3 != 2 ? 'A' + length % 26 : 0xC0 + length % 32));
+  }
+}
+
+TEST(StringMarshallingTest, IsAsciiString) {
+  EXPECT_TRUE(IsAsciiString("", 0));
+  EXPECT_TRUE(IsAsciiString("Hello", 5));
+
+  std::string text(40, 'a');
+  EXPECT_TRUE(IsAsciiString(text.c_str(), text.size()));
+
+  for (size_t index = 0; index < text.size(); ++index) {
+    std::string mutated = text;
+    mutated[index] = static_cast<char>(0xE9);
+
+    EXPECT_FALSE(IsAsciiString(mutated.c_str(), mutated.size())) << index;
+    EXPECT_TRUE(IsAsciiString(mutated.c_str(), index));
+  }
+}
+
+}  // namespace plugin